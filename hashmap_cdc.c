@@ -0,0 +1,319 @@
+/*
+
+   Copyright (c) 2011, Willem-Hendrik Thiart
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+ * The names of its contributors may not be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+   ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+   WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL WILLEM-HENDRIK THIART BE LIABLE FOR ANY
+   DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+   (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+   LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+   ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "linked_list_hashmap.h"
+#include "hashmap_snapshot.h"
+#include "hashmap_wal.h"
+#include "hashmap_cdc.h"
+
+/* replicas read this much at a time, at least */
+#define READ_SIZE (1 << 16)
+
+typedef struct
+{
+    char *data;
+    /* a power of two */
+    size_t size;
+
+    /* producer side. head only ever grows; head - tail bytes are waiting */
+    size_t head __attribute__((aligned(64)));
+    char *scratch;
+    size_t scratch_size;
+
+    /* consumer side */
+    size_t tail __attribute__((aligned(64)));
+    char *out;
+    size_t out_size;
+
+    /* set by the producer on overflow; the producer adds nothing more
+     * until hashmap_cdc_resume */
+    int overflow __attribute__((aligned(64)));
+} ring_t;
+
+/**
+ * The map's mutation hook. Producer side. */
+static void __on_mutation(
+    void *udata,
+    int op,
+    unsigned long hash,
+    void *key,
+    void *val
+    )
+{
+    hashmap_cdc_t *c = udata;
+    ring_t *r = c->ring;
+    size_t n, at, first;
+
+    if (__atomic_load_n(&r->overflow, __ATOMIC_RELAXED))
+        return;
+
+    if (HASHMAP_OP_PUT != op)
+        val = NULL;
+
+    n = hashmap_wal_encode(c->codec, op, hash, key, val,
+                           r->scratch, r->scratch_size);
+    if (r->scratch_size < n)
+    {
+        r->scratch_size = n * 2;
+        r->scratch = realloc(r->scratch, r->scratch_size);
+        hashmap_wal_encode(c->codec, op, hash, key, val,
+                           r->scratch, r->scratch_size);
+    }
+
+    /* the consumer has finished with everything before tail */
+    if (r->size - (r->head - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE)) < n)
+    {
+        __atomic_store_n(&r->overflow, 1, __ATOMIC_RELEASE);
+        return;
+    }
+
+    at = r->head & (r->size - 1);
+    first = r->size - at < n ? r->size - at : n;
+    memcpy(r->data + at, r->scratch, first);
+    memcpy(r->data, r->scratch + first, n - first);
+
+    /* publish the record */
+    __atomic_store_n(&r->head, r->head + n, __ATOMIC_RELEASE);
+}
+
+/**
+ * Copy every waiting record out of the ring. Consumer side.
+ * @return bytes copied into r->out */
+static size_t __take(
+    ring_t * r
+    )
+{
+    size_t head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+    size_t n = head - r->tail, at, first;
+
+    if (0 == n)
+        return 0;
+
+    if (r->out_size < n)
+    {
+        r->out_size = n;
+        free(r->out);
+        r->out = malloc(r->out_size);
+    }
+
+    at = r->tail & (r->size - 1);
+    first = r->size - at < n ? r->size - at : n;
+    memcpy(r->out, r->data + at, first);
+    memcpy(r->out + first, r->data, n - first);
+
+    /* hand the space back to the producer */
+    __atomic_store_n(&r->tail, head, __ATOMIC_RELEASE);
+    return n;
+}
+
+hashmap_cdc_t *hashmap_cdc_new(
+    hashmap_t * h,
+    const hashmap_codec_t * codec,
+    size_t ring_size
+    )
+{
+    hashmap_cdc_t *c;
+    ring_t *r;
+
+    if (posix_memalign((void**)&r, 64, sizeof(ring_t)))
+        return NULL;
+    memset(r, 0, sizeof(ring_t));
+
+    for (r->size = 64; r->size < ring_size; r->size *= 2)
+        ;
+    r->data = malloc(r->size);
+
+    c = calloc(1, sizeof(hashmap_cdc_t));
+    c->map = h;
+    c->codec = codec;
+    c->ring = r;
+
+    hashmap_set_mutation_hook(h, __on_mutation, c);
+    return c;
+}
+
+int hashmap_cdc_apply(
+    hashmap_cdc_t * c,
+    hashmap_t * replica,
+    hashmap_scan_f release
+    )
+{
+    ring_t *r = c->ring;
+    size_t len = __take(r), at = 0;
+    long n;
+    int count = 0;
+
+    while (0 < (n = hashmap_wal_apply(replica, r->out + at, len - at,
+                                      c->codec, release)))
+    {
+        at += n;
+        count++;
+    }
+
+    return count;
+}
+
+ssize_t hashmap_cdc_write(
+    hashmap_cdc_t * c,
+    int fd
+    )
+{
+    ring_t *r = c->ring;
+    size_t head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+    ssize_t done = 0;
+
+    /* straight from the ring, up to its end and then from its start */
+    while (r->tail != head)
+    {
+        size_t at = r->tail & (r->size - 1), len = head - r->tail;
+        ssize_t n;
+
+        if (r->size - at < len)
+            len = r->size - at;
+
+        if (-1 == (n = write(fd, r->data + at, len)))
+        {
+            if (EINTR == errno)
+                continue;
+            if (EAGAIN == errno || EWOULDBLOCK == errno)
+                break;
+            return -1;
+        }
+
+        /* only what was written is handed back to the producer */
+        __atomic_store_n(&r->tail, r->tail + n, __ATOMIC_RELEASE);
+        done += n;
+    }
+
+    return done;
+}
+
+int hashmap_cdc_overflowed(
+    hashmap_cdc_t * c
+    )
+{
+    ring_t *r = c->ring;
+
+    return __atomic_load_n(&r->overflow, __ATOMIC_ACQUIRE);
+}
+
+void hashmap_cdc_resume(
+    hashmap_cdc_t * c
+    )
+{
+    ring_t *r = c->ring;
+
+    r->tail = r->head;
+    __atomic_store_n(&r->overflow, 0, __ATOMIC_RELEASE);
+}
+
+void hashmap_cdc_free(
+    hashmap_cdc_t * c
+    )
+{
+    ring_t *r = c->ring;
+
+    hashmap_set_mutation_hook(c->map, NULL, NULL);
+    free(r->data);
+    free(r->scratch);
+    free(r->out);
+    free(r);
+    free(c);
+}
+
+hashmap_cdc_replica_t *hashmap_cdc_replica_new(
+    hashmap_t * replica,
+    const hashmap_codec_t * codec,
+    hashmap_scan_f release
+    )
+{
+    hashmap_cdc_replica_t *r = calloc(1, sizeof(hashmap_cdc_replica_t));
+
+    r->map = replica;
+    r->codec = codec;
+    r->release = release;
+    r->size = READ_SIZE;
+    r->buf = malloc(r->size);
+    return r;
+}
+
+int hashmap_cdc_replica_read(
+    hashmap_cdc_replica_t * r,
+    int fd
+    )
+{
+    size_t at = 0;
+    ssize_t got;
+    long n;
+    int count = 0;
+
+    /* room for at least one more read */
+    if (r->size - r->len < READ_SIZE / 2)
+    {
+        r->size *= 2;
+        r->buf = realloc(r->buf, r->size);
+    }
+
+    while (-1 == (got = read(fd, r->buf + r->len, r->size - r->len)) &&
+           EINTR == errno)
+        ;
+    if (got < 0)
+        return -1;
+    if (0 == got)
+        r->eof = 1;
+    r->len += got;
+
+    while (0 < (n = hashmap_wal_apply(r->map, r->buf + at, r->len - at,
+                                      r->codec, r->release)))
+    {
+        at += n;
+        count++;
+    }
+
+    /* keep the start of a record that hasn't fully arrived, or the damaged
+     * record, which stops every later read */
+    memmove(r->buf, r->buf + at, r->len - at);
+    r->len -= at;
+    return n < 0 ? -1 : count;
+}
+
+void hashmap_cdc_replica_free(
+    hashmap_cdc_replica_t * r
+    )
+{
+    free(r->buf);
+    free(r);
+}
+
+/*--------------------------------------------------------------79-characters-*/
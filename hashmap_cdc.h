@@ -0,0 +1,124 @@
+#ifndef HASHMAP_CDC_H
+#define HASHMAP_CDC_H
+
+/**
+ * A stream of the changes made to a hashmap_t, for keeping replicas up to
+ * date.
+ *
+ * A mutation hook encodes every change as a log record (the format of
+ * hashmap_wal.h) into a single-producer, single-consumer ring. The thread
+ * that changes the map is the producer. One consumer thread drains the ring
+ * in batches: either onto a replica map in the same process, or to a file
+ * descriptor that a hashmap_cdc_replica_t in another process reads from.
+ *
+ * If the consumer falls so far behind that a record doesn't fit, the
+ * stream stops and hashmap_cdc_overflowed says so. The replica has then
+ * missed changes and must be seeded again (e.g. from a snapshot) before
+ * hashmap_cdc_resume restarts the stream. */
+
+#include <sys/types.h>
+
+#include "linked_list_hashmap.h"
+#include "hashmap_snapshot.h"
+
+typedef struct
+{
+    hashmap_t *map;
+    const hashmap_codec_t *codec;
+    void *ring;
+} hashmap_cdc_t;
+
+typedef struct
+{
+    hashmap_t *map;
+    const hashmap_codec_t *codec;
+    hashmap_scan_f release;
+
+    /* bytes read but not yet applied */
+    char *buf;
+    size_t len;
+    size_t size;
+
+    /* the writer has closed its end */
+    int eof;
+} hashmap_cdc_replica_t;
+
+/**
+ * Start streaming the changes made to the map. This takes the map's
+ * mutation hook.
+ * @param ring_size : bytes of records that can wait for the consumer */
+hashmap_cdc_t *hashmap_cdc_new(
+    hashmap_t * hmap,
+    const hashmap_codec_t * codec,
+    size_t ring_size
+);
+
+/**
+ * Apply every waiting change to a replica. Consumer side.
+ * @param release : given the keys and values the changes replace, with the
+ *                  codec's udata. May be NULL
+ * @return number of changes applied */
+int hashmap_cdc_apply(
+    hashmap_cdc_t * c,
+    hashmap_t * replica,
+    hashmap_scan_f release
+);
+
+/**
+ * Write every waiting change to fd. Consumer side.
+ * Bytes that could not be written stay waiting, and the next call carries
+ * on from them, so a short or failed write loses nothing. A non-blocking
+ * fd that fills up ends the call early.
+ * @return bytes written; -1 on failure */
+ssize_t hashmap_cdc_write(
+    hashmap_cdc_t * c,
+    int fd
+);
+
+/**
+ * @return 1 if changes have been dropped, otherwise 0 */
+int hashmap_cdc_overflowed(
+    hashmap_cdc_t * c
+);
+
+/**
+ * Drop the waiting changes and restart the stream after an overflow.
+ * Neither side may be running: call it while the map is not changing and
+ * no consumer call is in progress, then seed the replica from the map. */
+void hashmap_cdc_resume(
+    hashmap_cdc_t * c
+);
+
+/**
+ * Stop streaming and remove the map's mutation hook. */
+void hashmap_cdc_free(
+    hashmap_cdc_t * c
+);
+
+/**
+ * Set up the receiving end of hashmap_cdc_write.
+ * @param release : see hashmap_cdc_apply */
+hashmap_cdc_replica_t *hashmap_cdc_replica_new(
+    hashmap_t * replica,
+    const hashmap_codec_t * codec,
+    hashmap_scan_f release
+);
+
+/**
+ * Read what is available from fd (one read), and apply every whole change.
+ * Sets eof once the writer has closed its end.
+ * On a damaged change, the changes before it stay applied and are dropped
+ * from the buffer, and -1 is returned. The damaged change is kept, so every
+ * later call also returns -1 without applying anything; seed the replica
+ * again and start a new one.
+ * @return number of changes applied; -1 on failure */
+int hashmap_cdc_replica_read(
+    hashmap_cdc_replica_t * r,
+    int fd
+);
+
+void hashmap_cdc_replica_free(
+    hashmap_cdc_replica_t * r
+);
+
+#endif /* HASHMAP_CDC_H */
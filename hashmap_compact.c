@@ -0,0 +1,246 @@
+/*
+
+   Copyright (c) 2011, Willem-Hendrik Thiart
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+ * The names of its contributors may not be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+   ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+   WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL WILLEM-HENDRIK THIART BE LIABLE FOR ANY
+   DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+   (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+   LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+   ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "linked_list_hashmap.h"
+#include "hashmap_compact.h"
+
+/* when we call for more buckets; items per bucket */
+#define MAX_LOAD 1.0
+
+/**
+ * Spread the hash, so that keys differing only in high bits still land in
+ * different buckets (splitmix64's finaliser) */
+static unsigned long __mix(
+    unsigned long x
+    )
+{
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9UL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebUL;
+    return x ^ (x >> 31);
+}
+
+static uint32_t *__head(
+    hashmap_compact_t * h,
+    unsigned long hash
+    )
+{
+    return &h->heads[__mix(hash) & (h->nbuckets - 1)];
+}
+
+/**
+ * @return the link that points at key's entry, or at the chain's end */
+static uint32_t *__find(
+    hashmap_compact_t * h,
+    unsigned long hash,
+    const void *key
+    )
+{
+    uint32_t *link = __head(h, hash);
+
+    while (*link && 0 != h->compare(key, h->entries[*link - 1].key))
+        link = &h->links[*link - 1];
+    return link;
+}
+
+static void __link_all(
+    hashmap_compact_t * h
+    )
+{
+    uint32_t ii;
+
+    memset(h->heads, 0, h->nbuckets * sizeof(uint32_t));
+    for (ii = 0; ii < h->count; ii++)
+    {
+        uint32_t *head = __head(h, h->hash(h->entries[ii].key));
+
+        h->links[ii] = *head;
+        *head = ii + 1;
+    }
+}
+
+static void __reserve(
+    hashmap_compact_t * h,
+    uint32_t capacity
+    )
+{
+    h->capacity = capacity;
+    h->entries = realloc(h->entries, capacity * sizeof(hashmap_entry_t));
+    h->links = realloc(h->links, capacity * sizeof(uint32_t));
+}
+
+hashmap_compact_t *hashmap_compact_new(
+    func_longhash_f hash,
+    func_longcmp_f cmp,
+    unsigned int initial_capacity
+    )
+{
+    hashmap_compact_t *h = calloc(1, sizeof(hashmap_compact_t));
+
+    for (h->nbuckets = 1; h->nbuckets * MAX_LOAD < initial_capacity;
+         h->nbuckets *= 2)
+        ;
+    h->heads = calloc(h->nbuckets, sizeof(uint32_t));
+    __reserve(h, initial_capacity ? initial_capacity : 1);
+    h->hash = hash;
+    h->compare = cmp;
+    return h;
+}
+
+int hashmap_compact_count(
+    hashmap_compact_t * h
+    )
+{
+    return h->count;
+}
+
+int hashmap_compact_size(
+    hashmap_compact_t * h
+    )
+{
+    return h->nbuckets;
+}
+
+void *hashmap_compact_get(
+    hashmap_compact_t * h,
+    const void *key
+    )
+{
+    uint32_t *link;
+
+    if (0 == h->count || !key)
+        return NULL;
+
+    link = __find(h, h->hash(key), key);
+    return *link ? h->entries[*link - 1].val : NULL;
+}
+
+int hashmap_compact_contains_key(
+    hashmap_compact_t * h,
+    const void *key
+    )
+{
+    return NULL != hashmap_compact_get(h, key);
+}
+
+void *hashmap_compact_put(
+    hashmap_compact_t * h,
+    void *key,
+    void *val
+    )
+{
+    unsigned long hash;
+    uint32_t *link;
+
+    if (!key || !val)
+        return NULL;
+
+    hash = h->hash(key);
+    link = __find(h, hash, key);
+    if (*link)
+    {
+        void *val_prev = h->entries[*link - 1].val;
+        h->entries[*link - 1].val = val;
+        return val_prev;
+    }
+
+    assert(h->count < UINT32_MAX - 1);
+
+    /* both of these can move the link we found */
+    if (h->count == h->capacity)
+    {
+        __reserve(h, h->capacity < UINT32_MAX / 2 ?
+                  h->capacity * 2 : UINT32_MAX - 1);
+        link = __find(h, hash, key);
+    }
+
+    if (h->nbuckets * MAX_LOAD <= h->count)
+    {
+        h->nbuckets *= 2;
+        free(h->heads);
+        h->heads = malloc(h->nbuckets * sizeof(uint32_t));
+        __link_all(h);
+        link = __find(h, hash, key);
+    }
+
+    /* new entries go on the end of their chain */
+    h->entries[h->count].key = key;
+    h->entries[h->count].val = val;
+    h->links[h->count] = 0;
+    *link = ++h->count;
+    return NULL;
+}
+
+void *hashmap_compact_remove(
+    hashmap_compact_t * h,
+    const void *key
+    )
+{
+    uint32_t *link, idx, last;
+    void *val;
+
+    if (0 == h->count || !key)
+        return NULL;
+
+    link = __find(h, h->hash(key), key);
+    if (!*link)
+        return NULL;
+
+    idx = *link - 1;
+    val = h->entries[idx].val;
+    *link = h->links[idx];
+
+    /* keep entries packed by moving the last one into the hole */
+    last = --h->count;
+    if (idx != last)
+    {
+        link = __find(h, h->hash(h->entries[last].key),
+                      h->entries[last].key);
+        *link = idx + 1;
+        h->entries[idx] = h->entries[last];
+        h->links[idx] = h->links[last];
+    }
+
+    return val;
+}
+
+void hashmap_compact_freeall(
+    hashmap_compact_t * h
+    )
+{
+    free(h->heads);
+    free(h->entries);
+    free(h->links);
+    free(h);
+}
+
+/*--------------------------------------------------------------79-characters-*/
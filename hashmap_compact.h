@@ -0,0 +1,92 @@
+#ifndef HASHMAP_COMPACT_H
+#define HASHMAP_COMPACT_H
+
+/**
+ * A chained hashmap with a small per-entry footprint.
+ *
+ * Entries live in one map-owned array, packed at the front, and chains
+ * link them by 32-bit index rather than by pointer. Buckets are 32-bit
+ * chain heads too. An entry costs its key and value, a 4-byte link, and
+ * about 4 bytes of bucket; there is no per-entry allocation.
+ *
+ * Removal moves the last entry into the hole, so removing can reorder
+ * entries. The map holds at most UINT32_MAX - 1 entries. */
+
+#include <stdint.h>
+
+#include "linked_list_hashmap.h"
+
+typedef struct
+{
+    uint32_t count;
+    /* number of buckets; always a power of two */
+    uint32_t nbuckets;
+    /* chain heads; entry index + 1, 0 is an empty bucket */
+    uint32_t *heads;
+    /* number of slots in entries and links */
+    uint32_t capacity;
+    hashmap_entry_t *entries;
+    /* next entry in the chain; entry index + 1, 0 ends the chain */
+    uint32_t *links;
+    func_longhash_f hash;
+    func_longcmp_f compare;
+} hashmap_compact_t;
+
+hashmap_compact_t *hashmap_compact_new(
+    func_longhash_f hash,
+    func_longcmp_f cmp,
+    unsigned int initial_capacity
+);
+
+/**
+ * @return number of items within hash */
+int hashmap_compact_count(
+    hashmap_compact_t * h
+);
+
+/**
+ * @return number of buckets */
+int hashmap_compact_size(
+    hashmap_compact_t * h
+);
+
+/**
+ * Get this key's value.
+ * @return key's item, otherwise NULL */
+void *hashmap_compact_get(
+    hashmap_compact_t * h,
+    const void *key
+);
+
+/**
+ * Is this key inside this map?
+ * @return 1 if key is in hash, otherwise 0 */
+int hashmap_compact_contains_key(
+    hashmap_compact_t * h,
+    const void *key
+);
+
+/**
+ * Associate key with val.
+ * @return previous associated val; otherwise NULL */
+void *hashmap_compact_put(
+    hashmap_compact_t * h,
+    void *key,
+    void *val
+);
+
+/**
+ * Remove this key and value from the map.
+ * @return value of key, or NULL on failure */
+void *hashmap_compact_remove(
+    hashmap_compact_t * h,
+    const void *key
+);
+
+/**
+ * Free all the memory related to this hash. */
+void hashmap_compact_freeall(
+    hashmap_compact_t * h
+);
+
+#endif /* HASHMAP_COMPACT_H */
@@ -0,0 +1,346 @@
+/*
+
+   Copyright (c) 2011, Willem-Hendrik Thiart
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+ * The names of its contributors may not be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+   ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+   WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL WILLEM-HENDRIK THIART BE LIABLE FOR ANY
+   DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+   (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+   LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+   ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "linked_list_hashmap.h"
+#include "hashmap_cuckoo.h"
+
+#define SLOTS_PER_BUCKET 4
+
+/* moves an insert may make before the map grows */
+#define MAX_KICKS 500
+
+/* grow before the walks to find room get long */
+#define MAX_LOAD 0.95
+
+typedef struct
+{
+    void *keys[SLOTS_PER_BUCKET];
+    void *vals[SLOTS_PER_BUCKET];
+} __attribute__((aligned(64))) bucket_t;
+
+static void __grow(
+    hashmap_cuckoo_t * h
+    );
+
+/**
+ * Second hash from the first (splitmix64's finaliser) */
+static unsigned long __mix(
+    unsigned long x
+    )
+{
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9UL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebUL;
+    return x ^ (x >> 31);
+}
+
+/**
+ * The key's two buckets */
+static void __buckets(
+    hashmap_cuckoo_t * h,
+    unsigned long hash,
+    unsigned int *b1,
+    unsigned int *b2
+    )
+{
+    unsigned int mask = h->nbuckets - 1;
+
+    *b1 = hash & mask;
+    *b2 = __mix(hash) & mask;
+    if (*b1 == *b2)
+        *b2 = *b1 ^ 1;
+}
+
+static bucket_t *__bucket(
+    hashmap_cuckoo_t * h,
+    unsigned int b
+    )
+{
+    return &((bucket_t*)h->buckets)[b];
+}
+
+/**
+ * @return slot holding key; otherwise -1 */
+static int __find_in(
+    hashmap_cuckoo_t * h,
+    bucket_t * b,
+    const void *key
+    )
+{
+    int ii;
+
+    for (ii = 0; ii < SLOTS_PER_BUCKET; ii++)
+        if (b->keys[ii] && 0 == h->compare(key, b->keys[ii]))
+            return ii;
+    return -1;
+}
+
+/**
+ * @return the bucket holding key, with its slot in *slot; otherwise NULL */
+static bucket_t *__find(
+    hashmap_cuckoo_t * h,
+    const void *key,
+    int *slot
+    )
+{
+    unsigned int b1, b2;
+    bucket_t *b;
+
+    __buckets(h, h->hash(key), &b1, &b2);
+
+    /* fetch both lines at once */
+    __builtin_prefetch(__bucket(h, b2));
+
+    b = __bucket(h, b1);
+    if (0 <= (*slot = __find_in(h, b, key)))
+        return b;
+
+    b = __bucket(h, b2);
+    if (0 <= (*slot = __find_in(h, b, key)))
+        return b;
+
+    return NULL;
+}
+
+/**
+ * Put key in an empty slot of bucket b.
+ * @return 1 if there was one, otherwise 0 */
+static int __take_slot(
+    bucket_t * b,
+    void *key,
+    void *val
+    )
+{
+    int ii;
+
+    for (ii = 0; ii < SLOTS_PER_BUCKET; ii++)
+        if (!b->keys[ii])
+        {
+            b->keys[ii] = key;
+            b->vals[ii] = val;
+            return 1;
+        }
+    return 0;
+}
+
+/**
+ * Place a key that isn't in the map, moving other keys out of the way.
+ * Grows the map if no room turns up. */
+static void __insert(
+    hashmap_cuckoo_t * h,
+    void *key,
+    void *val
+    )
+{
+    unsigned int b1, b2, b;
+    int kick;
+
+    __buckets(h, h->hash(key), &b1, &b2);
+    if (__take_slot(__bucket(h, b1), key, val) ||
+        __take_slot(__bucket(h, b2), key, val))
+        return;
+
+    /* random walk: swap with a key in one of our buckets, then send that
+     * key to its other bucket */
+    b = b1;
+    for (kick = 0; kick < MAX_KICKS; kick++)
+    {
+        bucket_t *bk = __bucket(h, b);
+        unsigned int o1, o2;
+        void *k, *v;
+        int slot;
+
+        /* xorshift */
+        h->rand ^= h->rand << 13;
+        h->rand ^= h->rand >> 7;
+        h->rand ^= h->rand << 17;
+        slot = h->rand % SLOTS_PER_BUCKET;
+
+        k = bk->keys[slot];
+        v = bk->vals[slot];
+        bk->keys[slot] = key;
+        bk->vals[slot] = val;
+        key = k;
+        val = v;
+
+        __buckets(h, h->hash(key), &o1, &o2);
+        b = o1 == b ? o2 : o1;
+        if (__take_slot(__bucket(h, b), key, val))
+            return;
+    }
+
+    /* the key in hand is the last one displaced */
+    __grow(h);
+    __insert(h, key, val);
+}
+
+static void *__alloc_buckets(
+    unsigned int nbuckets
+    )
+{
+    void *b;
+
+    if (posix_memalign(&b, 64, nbuckets * sizeof(bucket_t)))
+        return NULL;
+    memset(b, 0, nbuckets * sizeof(bucket_t));
+    return b;
+}
+
+static void __grow(
+    hashmap_cuckoo_t * h
+    )
+{
+    bucket_t *old = h->buckets;
+    unsigned int ii, nold = h->nbuckets;
+    int jj;
+
+    h->nbuckets *= 2;
+    h->buckets = __alloc_buckets(h->nbuckets);
+
+    for (ii = 0; ii < nold; ii++)
+        for (jj = 0; jj < SLOTS_PER_BUCKET; jj++)
+            if (old[ii].keys[jj])
+                __insert(h, old[ii].keys[jj], old[ii].vals[jj]);
+
+    free(old);
+}
+
+hashmap_cuckoo_t *hashmap_cuckoo_new(
+    func_longhash_f hash,
+    func_longcmp_f cmp,
+    unsigned int initial_capacity
+    )
+{
+    hashmap_cuckoo_t *h = calloc(1, sizeof(hashmap_cuckoo_t));
+
+    /* at least two buckets, so that every key has two */
+    for (h->nbuckets = 2;
+         h->nbuckets * SLOTS_PER_BUCKET * MAX_LOAD < initial_capacity;
+         h->nbuckets *= 2)
+        ;
+    h->buckets = __alloc_buckets(h->nbuckets);
+    h->rand = 0x2545f4914f6cdd1dUL;
+    h->hash = hash;
+    h->compare = cmp;
+    return h;
+}
+
+int hashmap_cuckoo_count(
+    hashmap_cuckoo_t * h
+    )
+{
+    return h->count;
+}
+
+int hashmap_cuckoo_size(
+    hashmap_cuckoo_t * h
+    )
+{
+    return h->nbuckets * SLOTS_PER_BUCKET;
+}
+
+void *hashmap_cuckoo_get(
+    hashmap_cuckoo_t * h,
+    const void *key
+    )
+{
+    bucket_t *b;
+    int slot;
+
+    if (0 == h->count || !key || !(b = __find(h, key, &slot)))
+        return NULL;
+    return b->vals[slot];
+}
+
+int hashmap_cuckoo_contains_key(
+    hashmap_cuckoo_t * h,
+    const void *key
+    )
+{
+    return NULL != hashmap_cuckoo_get(h, key);
+}
+
+void *hashmap_cuckoo_put(
+    hashmap_cuckoo_t * h,
+    void *key,
+    void *val
+    )
+{
+    bucket_t *b;
+    int slot;
+
+    if (!key || !val)
+        return NULL;
+
+    if ((b = __find(h, key, &slot)))
+    {
+        void *val_prev = b->vals[slot];
+        b->vals[slot] = val;
+        return val_prev;
+    }
+
+    if (hashmap_cuckoo_size(h) * MAX_LOAD <= h->count + 1)
+        __grow(h);
+
+    __insert(h, key, val);
+    h->count++;
+    return NULL;
+}
+
+void *hashmap_cuckoo_remove(
+    hashmap_cuckoo_t * h,
+    const void *key
+    )
+{
+    bucket_t *b;
+    void *val;
+    int slot;
+
+    if (!key || !(b = __find(h, key, &slot)))
+        return NULL;
+
+    val = b->vals[slot];
+    b->keys[slot] = NULL;
+    b->vals[slot] = NULL;
+    h->count--;
+    return val;
+}
+
+void hashmap_cuckoo_freeall(
+    hashmap_cuckoo_t * h
+    )
+{
+    free(h->buckets);
+    free(h);
+}
+
+/*--------------------------------------------------------------79-characters-*/
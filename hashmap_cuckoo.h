@@ -0,0 +1,87 @@
+#ifndef HASHMAP_CUCKOO_H
+#define HASHMAP_CUCKOO_H
+
+/**
+ * A hashmap using bucketized cuckoo hashing.
+ *
+ * Each key has two candidate buckets, both derived from the map's hash.
+ * A bucket is one 64-byte cache line of four slots. A lookup reads at most
+ * those two lines, however full the map is. An insert that finds both
+ * buckets full moves existing keys to their other bucket to make room,
+ * and the map doubles if that takes too long.
+ *
+ * Keys with equal hashes share both buckets, so no more than eight keys
+ * may have the same hash. */
+
+#include "linked_list_hashmap.h"
+
+typedef struct
+{
+    int count;
+    /* number of buckets; always a power of two */
+    unsigned int nbuckets;
+    void *buckets;
+    /* picks which key to move when both buckets are full */
+    unsigned long rand;
+    func_longhash_f hash;
+    func_longcmp_f compare;
+} hashmap_cuckoo_t;
+
+hashmap_cuckoo_t *hashmap_cuckoo_new(
+    func_longhash_f hash,
+    func_longcmp_f cmp,
+    unsigned int initial_capacity
+);
+
+/**
+ * @return number of items within hash */
+int hashmap_cuckoo_count(
+    hashmap_cuckoo_t * h
+);
+
+/**
+ * @return number of slots */
+int hashmap_cuckoo_size(
+    hashmap_cuckoo_t * h
+);
+
+/**
+ * Get this key's value.
+ * @return key's item, otherwise NULL */
+void *hashmap_cuckoo_get(
+    hashmap_cuckoo_t * h,
+    const void *key
+);
+
+/**
+ * Is this key inside this map?
+ * @return 1 if key is in hash, otherwise 0 */
+int hashmap_cuckoo_contains_key(
+    hashmap_cuckoo_t * h,
+    const void *key
+);
+
+/**
+ * Associate key with val.
+ * @return previous associated val; otherwise NULL */
+void *hashmap_cuckoo_put(
+    hashmap_cuckoo_t * h,
+    void *key,
+    void *val
+);
+
+/**
+ * Remove this key and value from the map.
+ * @return value of key, or NULL on failure */
+void *hashmap_cuckoo_remove(
+    hashmap_cuckoo_t * h,
+    const void *key
+);
+
+/**
+ * Free all the memory related to this hash. */
+void hashmap_cuckoo_freeall(
+    hashmap_cuckoo_t * h
+);
+
+#endif /* HASHMAP_CUCKOO_H */
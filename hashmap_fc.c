@@ -0,0 +1,267 @@
+/*
+
+   Copyright (c) 2011, Willem-Hendrik Thiart
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+ * The names of its contributors may not be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+   ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+   WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL WILLEM-HENDRIK THIART BE LIABLE FOR ANY
+   DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+   (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+   LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+   ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <sched.h>
+
+#include "linked_list_hashmap.h"
+#include "hashmap_fc.h"
+
+/* passes the combiner makes over the slots before letting go */
+#define COMBINE_PASSES 2
+
+/* how long a waiting thread spins before yielding the CPU */
+#define SPINS_BEFORE_YIELD 256
+
+#define CACHE_LINE 64
+
+enum {
+    OP_GET,
+    OP_PUT,
+    OP_PUT_IF_ABSENT,
+    OP_REPLACE_IF,
+    OP_REMOVE,
+    OP_REMOVE_IF,
+};
+
+typedef struct
+{
+    int in_use;
+    /* set by the publisher; cleared by the combiner once applied */
+    int pending;
+    int op;
+    void *key;
+    void *val;
+    const void *expected;
+    void *result;
+} __attribute__((aligned(CACHE_LINE))) slot_t;
+
+hashmap_fc_t *hashmap_fc_new(
+    func_longhash_f hash,
+    func_longcmp_f cmp,
+    unsigned int initial_capacity,
+    unsigned int max_threads
+    )
+{
+    hashmap_fc_t *h;
+    void *slots;
+
+    assert(0 < max_threads);
+
+    if (0 != posix_memalign(&slots, CACHE_LINE, max_threads * sizeof(slot_t)))
+        return NULL;
+    memset(slots, 0, max_threads * sizeof(slot_t));
+
+    h = calloc(1, sizeof(hashmap_fc_t));
+    h->map = hashmap_new(hash, cmp, initial_capacity);
+    h->nslots = max_threads;
+    h->slots = slots;
+    return h;
+}
+
+int hashmap_fc_register(hashmap_fc_t * h)
+{
+    int ii;
+
+    for (ii = 0; ii < h->nslots; ii++)
+    {
+        slot_t *s = &((slot_t*)h->slots)[ii];
+
+        if (!__atomic_exchange_n(&s->in_use, 1, __ATOMIC_ACQ_REL))
+            return ii;
+    }
+
+    return -1;
+}
+
+void hashmap_fc_unregister(hashmap_fc_t * h, int slot)
+{
+    slot_t *s = &((slot_t*)h->slots)[slot];
+
+    assert(!s->pending);
+    __atomic_store_n(&s->in_use, 0, __ATOMIC_RELEASE);
+}
+
+int hashmap_fc_count(hashmap_fc_t * h)
+{
+    return __atomic_load_n(&h->map->count, __ATOMIC_RELAXED);
+}
+
+static void __execute(hashmap_t * m, slot_t * s)
+{
+    switch (s->op)
+    {
+    case OP_GET:
+        s->result = hashmap_get(m, s->key);
+        break;
+    case OP_PUT:
+        s->result = hashmap_put(m, s->key, s->val);
+        break;
+    case OP_PUT_IF_ABSENT:
+        s->result = hashmap_put_if_absent(m, s->key, s->val);
+        break;
+    case OP_REPLACE_IF:
+        s->result = (void*)(long)hashmap_replace_if(m, s->key, s->expected,
+                                                    s->val);
+        break;
+    case OP_REMOVE:
+        s->result = hashmap_remove(m, s->key);
+        break;
+    case OP_REMOVE_IF:
+        s->result = (void*)(long)hashmap_remove_if(m, s->key, s->expected);
+        break;
+    }
+}
+
+/**
+ * Apply every pending request, as the only thread touching the map. */
+static void __combine(hashmap_fc_t * h)
+{
+    int pass, ii;
+
+    for (pass = 0; pass < COMBINE_PASSES; pass++)
+        for (ii = 0; ii < h->nslots; ii++)
+        {
+            slot_t *s = &((slot_t*)h->slots)[ii];
+
+            if (!__atomic_load_n(&s->pending, __ATOMIC_ACQUIRE))
+                continue;
+
+            __execute(h->map, s);
+            __atomic_store_n(&s->pending, 0, __ATOMIC_RELEASE);
+        }
+}
+
+/**
+ * Publish a request and wait until some combiner has applied it. */
+static void *__publish(
+    hashmap_fc_t * h,
+    int slot,
+    int op,
+    const void *key,
+    const void *expected,
+    void *val
+    )
+{
+    slot_t *s = &((slot_t*)h->slots)[slot];
+    int spins = 0;
+
+    assert(s->in_use);
+
+    s->op = op;
+    s->key = (void*)key;
+    s->expected = expected;
+    s->val = val;
+    __atomic_store_n(&s->pending, 1, __ATOMIC_RELEASE);
+
+    while (1)
+    {
+        if (!__atomic_load_n(&h->combining, __ATOMIC_RELAXED) &&
+            !__atomic_exchange_n(&h->combining, 1, __ATOMIC_ACQUIRE))
+        {
+            __combine(h);
+            __atomic_store_n(&h->combining, 0, __ATOMIC_RELEASE);
+        }
+
+        if (!__atomic_load_n(&s->pending, __ATOMIC_ACQUIRE))
+            return s->result;
+
+        if (++spins % SPINS_BEFORE_YIELD == 0)
+            sched_yield();
+    }
+}
+
+void *hashmap_fc_get(hashmap_fc_t * h, int slot, const void *key)
+{
+    if (!key)
+        return NULL;
+    return __publish(h, slot, OP_GET, key, NULL, NULL);
+}
+
+void *hashmap_fc_put(hashmap_fc_t * h, int slot, void *key, void *val)
+{
+    if (!key || !val)
+        return NULL;
+    return __publish(h, slot, OP_PUT, key, NULL, val);
+}
+
+void *hashmap_fc_put_if_absent(
+    hashmap_fc_t * h,
+    int slot,
+    void *key,
+    void *val
+    )
+{
+    if (!key || !val)
+        return NULL;
+    return __publish(h, slot, OP_PUT_IF_ABSENT, key, NULL, val);
+}
+
+int hashmap_fc_replace_if(
+    hashmap_fc_t * h,
+    int slot,
+    const void *key,
+    const void *expected,
+    void *val_new
+    )
+{
+    if (!key || !val_new)
+        return 0;
+    return NULL != __publish(h, slot, OP_REPLACE_IF, key, expected, val_new);
+}
+
+void *hashmap_fc_remove(hashmap_fc_t * h, int slot, const void *key)
+{
+    if (!key)
+        return NULL;
+    return __publish(h, slot, OP_REMOVE, key, NULL, NULL);
+}
+
+int hashmap_fc_remove_if(
+    hashmap_fc_t * h,
+    int slot,
+    const void *key,
+    const void *expected
+    )
+{
+    if (!key)
+        return 0;
+    return NULL != __publish(h, slot, OP_REMOVE_IF, key, expected, NULL);
+}
+
+void hashmap_fc_freeall(hashmap_fc_t * h)
+{
+    hashmap_freeall(h->map);
+    free(h->slots);
+    free(h);
+}
+
+/*--------------------------------------------------------------79-characters-*/
@@ -0,0 +1,119 @@
+#ifndef HASHMAP_FC_H
+#define HASHMAP_FC_H
+
+/**
+ * A flat-combining hashmap for write-heavy, high-contention use.
+ *
+ * Each thread registers for a publication slot. An operation is published
+ * into the thread's slot; whichever thread takes the combiner flag then
+ * applies every pending request to the underlying hashmap_t in one pass,
+ * while the map's cache lines are hot, and hands the results back. Nobody
+ * else touches the hashmap_t, so it needs no locking of its own. */
+
+#include "linked_list_hashmap.h"
+
+typedef struct
+{
+    hashmap_t *map;
+    int nslots;
+    void *slots;
+    /* set while a thread is combining */
+    int combining;
+} hashmap_fc_t;
+
+/**
+ * @param max_threads : number of threads that may be registered at once */
+hashmap_fc_t *hashmap_fc_new(
+    func_longhash_f hash,
+    func_longcmp_f cmp,
+    unsigned int initial_capacity,
+    unsigned int max_threads
+);
+
+/**
+ * Claim a publication slot for the calling thread.
+ * @return slot to pass to the other functions; -1 if all slots are taken */
+int hashmap_fc_register(
+    hashmap_fc_t * h
+);
+
+/**
+ * Give this thread's slot back. */
+void hashmap_fc_unregister(
+    hashmap_fc_t * h,
+    int slot
+);
+
+/**
+ * @return number of items within hash */
+int hashmap_fc_count(
+    hashmap_fc_t * h
+);
+
+/**
+ * Get this key's value.
+ * @return key's item, otherwise NULL */
+void *hashmap_fc_get(
+    hashmap_fc_t * h,
+    int slot,
+    const void *key
+);
+
+/**
+ * Associate key with val.
+ * @return previous associated val; otherwise NULL */
+void *hashmap_fc_put(
+    hashmap_fc_t * h,
+    int slot,
+    void *key,
+    void *val
+);
+
+/**
+ * Associate key with val, unless an equal key exists.
+ * @return val already associated with key; otherwise NULL */
+void *hashmap_fc_put_if_absent(
+    hashmap_fc_t * h,
+    int slot,
+    void *key,
+    void *val
+);
+
+/**
+ * Associate key with val_new, if key is currently associated with expected.
+ * @return 1 if replaced, otherwise 0 */
+int hashmap_fc_replace_if(
+    hashmap_fc_t * h,
+    int slot,
+    const void *key,
+    const void *expected,
+    void *val_new
+);
+
+/**
+ * Remove this key and value from the map.
+ * @return value of key, or NULL on failure */
+void *hashmap_fc_remove(
+    hashmap_fc_t * h,
+    int slot,
+    const void *key
+);
+
+/**
+ * Remove key, if it is currently associated with expected.
+ * @return 1 if removed, otherwise 0 */
+int hashmap_fc_remove_if(
+    hashmap_fc_t * h,
+    int slot,
+    const void *key,
+    const void *expected
+);
+
+/**
+ * Free all the memory related to this hash.
+ * No other thread may be using the map. */
+void hashmap_fc_freeall(
+    hashmap_fc_t * h
+);
+
+#endif /* HASHMAP_FC_H */
@@ -0,0 +1,316 @@
+/*
+
+   Copyright (c) 2011, Willem-Hendrik Thiart
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+ * The names of its contributors may not be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+   ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+   WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL WILLEM-HENDRIK THIART BE LIABLE FOR ANY
+   DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+   (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+   LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+   ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "linked_list_hashmap.h"
+#include "hashmap_hopscotch.h"
+
+/* slots in a neighbourhood; one bit each in a hop bitmap */
+#define NEIGHBOURHOOD 32
+
+/* how far an insert looks for a free slot before the map grows */
+#define ADD_RANGE 512
+
+/* when we call for more capacity */
+#define MAX_LOAD 0.95
+
+typedef struct
+{
+    void *key;
+    void *val;
+} slot_t;
+
+/**
+ * Spread the hash, so that keys differing only in high bits still get
+ * different homes (splitmix64's finaliser) */
+static unsigned long __mix(
+    unsigned long x
+    )
+{
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9UL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebUL;
+    return x ^ (x >> 31);
+}
+
+static unsigned int __home(
+    hashmap_hopscotch_t * h,
+    const void *key
+    )
+{
+    return __mix(h->hash(key)) & (h->size - 1);
+}
+
+static slot_t *__slot(
+    hashmap_hopscotch_t * h,
+    unsigned int ii
+    )
+{
+    return &((slot_t*)h->slots)[ii];
+}
+
+static unsigned int __nslots(
+    hashmap_hopscotch_t * h
+    )
+{
+    return h->size + NEIGHBOURHOOD - 1;
+}
+
+/**
+ * @return slot holding key; otherwise -1 */
+static int __find(
+    hashmap_hopscotch_t * h,
+    const void *key
+    )
+{
+    unsigned int home = __home(h, key), bits = h->hops[home];
+
+    while (bits)
+    {
+        int ii = __builtin_ctz(bits);
+        slot_t *s = __slot(h, home + ii);
+
+        if (0 == h->compare(key, s->key))
+            return home + ii;
+        bits &= bits - 1;
+    }
+
+    return -1;
+}
+
+/**
+ * Move a key from before free slot j into it, keeping that key within its
+ * neighbourhood.
+ * @return the slot freed up; -1 if no key can move */
+static int __hop_back(
+    hashmap_hopscotch_t * h,
+    unsigned int j
+    )
+{
+    unsigned int b;
+
+    /* j may be in the tail past the last home */
+    for (b = j - (NEIGHBOURHOOD - 1); b < j && b < h->size; b++)
+    {
+        unsigned int bits = h->hops[b];
+
+        /* the first of b's keys that sits before j */
+        if (bits && b + __builtin_ctz(bits) < j)
+        {
+            unsigned int from = b + __builtin_ctz(bits);
+
+            *__slot(h, j) = *__slot(h, from);
+            __slot(h, from)->key = NULL;
+            h->hops[b] &= ~(1u << (from - b));
+            h->hops[b] |= 1u << (j - b);
+            return from;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * Place a key that isn't in the map.
+ * @return 1 on success; 0 if the map must grow first */
+static int __insert(
+    hashmap_hopscotch_t * h,
+    void *key,
+    void *val
+    )
+{
+    unsigned int home = __home(h, key), end = __nslots(h), j;
+
+    if (home + ADD_RANGE < end)
+        end = home + ADD_RANGE;
+
+    for (j = home; j < end && __slot(h, j)->key; j++)
+        ;
+    if (j == end)
+        return 0;
+
+    /* hop the free slot back until it is in the home's neighbourhood */
+    while (NEIGHBOURHOOD <= j - home)
+    {
+        int freed = __hop_back(h, j);
+
+        if (freed < 0)
+            return 0;
+        j = freed;
+    }
+
+    __slot(h, j)->key = key;
+    __slot(h, j)->val = val;
+    h->hops[home] |= 1u << (j - home);
+    return 1;
+}
+
+static void __alloc(
+    hashmap_hopscotch_t * h,
+    unsigned int size
+    )
+{
+    h->size = size;
+    h->slots = calloc(__nslots(h), sizeof(slot_t));
+    h->hops = calloc(size, sizeof(unsigned int));
+}
+
+static void __grow(
+    hashmap_hopscotch_t * h
+    )
+{
+    slot_t *old = h->slots;
+    unsigned int *old_hops = h->hops, ii, nold = __nslots(h);
+
+    __alloc(h, h->size * 2);
+
+    for (ii = 0; ii < nold; ii++)
+        if (old[ii].key)
+            /* rarely, the bigger table is still too crowded somewhere */
+            while (!__insert(h, old[ii].key, old[ii].val))
+                __grow(h);
+
+    free(old);
+    free(old_hops);
+}
+
+hashmap_hopscotch_t *hashmap_hopscotch_new(
+    func_longhash_f hash,
+    func_longcmp_f cmp,
+    unsigned int initial_capacity
+    )
+{
+    hashmap_hopscotch_t *h = calloc(1, sizeof(hashmap_hopscotch_t));
+    unsigned int size;
+
+    for (size = NEIGHBOURHOOD; size * MAX_LOAD < initial_capacity; size *= 2)
+        ;
+    __alloc(h, size);
+    h->hash = hash;
+    h->compare = cmp;
+    return h;
+}
+
+int hashmap_hopscotch_count(
+    hashmap_hopscotch_t * h
+    )
+{
+    return h->count;
+}
+
+int hashmap_hopscotch_size(
+    hashmap_hopscotch_t * h
+    )
+{
+    return h->size;
+}
+
+void *hashmap_hopscotch_get(
+    hashmap_hopscotch_t * h,
+    const void *key
+    )
+{
+    int ii;
+
+    if (0 == h->count || !key || (ii = __find(h, key)) < 0)
+        return NULL;
+    return __slot(h, ii)->val;
+}
+
+int hashmap_hopscotch_contains_key(
+    hashmap_hopscotch_t * h,
+    const void *key
+    )
+{
+    return NULL != hashmap_hopscotch_get(h, key);
+}
+
+void *hashmap_hopscotch_put(
+    hashmap_hopscotch_t * h,
+    void *key,
+    void *val
+    )
+{
+    int ii;
+
+    if (!key || !val)
+        return NULL;
+
+    if (0 <= (ii = __find(h, key)))
+    {
+        void *val_prev = __slot(h, ii)->val;
+        __slot(h, ii)->val = val;
+        return val_prev;
+    }
+
+    if (h->size * MAX_LOAD <= h->count + 1)
+        __grow(h);
+
+    while (!__insert(h, key, val))
+        __grow(h);
+
+    h->count++;
+    return NULL;
+}
+
+void *hashmap_hopscotch_remove(
+    hashmap_hopscotch_t * h,
+    const void *key
+    )
+{
+    unsigned int home;
+    slot_t *s;
+    void *val;
+    int ii;
+
+    if (!key || (ii = __find(h, key)) < 0)
+        return NULL;
+
+    s = __slot(h, ii);
+    val = s->val;
+    home = __home(h, key);
+    h->hops[home] &= ~(1u << (ii - home));
+    s->key = NULL;
+    s->val = NULL;
+    h->count--;
+    return val;
+}
+
+void hashmap_hopscotch_freeall(
+    hashmap_hopscotch_t * h
+    )
+{
+    free(h->slots);
+    free(h->hops);
+    free(h);
+}
+
+/*--------------------------------------------------------------79-characters-*/
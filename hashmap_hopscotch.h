@@ -0,0 +1,88 @@
+#ifndef HASHMAP_HOPSCOTCH_H
+#define HASHMAP_HOPSCOTCH_H
+
+/**
+ * A hashmap using hopscotch hashing, for dense tables.
+ *
+ * Entries live in one open-addressed array. Every key is kept within a
+ * neighbourhood of 32 slots from its home slot, and each home slot has a
+ * bitmap of which neighbourhood slots hold its keys. A lookup only looks
+ * at those slots. An insert that finds its free slot too far away moves
+ * other keys closer to their homes until the slot is in reach.
+ *
+ * Tables stay fast up to 95% full, at 20 bytes per slot and with no
+ * per-entry allocations. No more than 32 keys may have the same hash. */
+
+#include "linked_list_hashmap.h"
+
+typedef struct
+{
+    int count;
+    /* number of home slots; always a power of two */
+    unsigned int size;
+    /* key/value slots; the last neighbourhood runs past size */
+    void *slots;
+    /* per home slot, a bit for each neighbourhood slot holding its keys */
+    unsigned int *hops;
+    func_longhash_f hash;
+    func_longcmp_f compare;
+} hashmap_hopscotch_t;
+
+hashmap_hopscotch_t *hashmap_hopscotch_new(
+    func_longhash_f hash,
+    func_longcmp_f cmp,
+    unsigned int initial_capacity
+);
+
+/**
+ * @return number of items within hash */
+int hashmap_hopscotch_count(
+    hashmap_hopscotch_t * h
+);
+
+/**
+ * @return number of home slots */
+int hashmap_hopscotch_size(
+    hashmap_hopscotch_t * h
+);
+
+/**
+ * Get this key's value.
+ * @return key's item, otherwise NULL */
+void *hashmap_hopscotch_get(
+    hashmap_hopscotch_t * h,
+    const void *key
+);
+
+/**
+ * Is this key inside this map?
+ * @return 1 if key is in hash, otherwise 0 */
+int hashmap_hopscotch_contains_key(
+    hashmap_hopscotch_t * h,
+    const void *key
+);
+
+/**
+ * Associate key with val.
+ * @return previous associated val; otherwise NULL */
+void *hashmap_hopscotch_put(
+    hashmap_hopscotch_t * h,
+    void *key,
+    void *val
+);
+
+/**
+ * Remove this key and value from the map.
+ * @return value of key, or NULL on failure */
+void *hashmap_hopscotch_remove(
+    hashmap_hopscotch_t * h,
+    const void *key
+);
+
+/**
+ * Free all the memory related to this hash. */
+void hashmap_hopscotch_freeall(
+    hashmap_hopscotch_t * h
+);
+
+#endif /* HASHMAP_HOPSCOTCH_H */
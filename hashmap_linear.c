@@ -0,0 +1,306 @@
+/*
+
+   Copyright (c) 2011, Willem-Hendrik Thiart
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+ * The names of its contributors may not be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+   ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+   WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL WILLEM-HENDRIK THIART BE LIABLE FOR ANY
+   DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+   (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+   LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+   ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "linked_list_hashmap.h"
+#include "hashmap_linear.h"
+
+/* buckets per segment */
+#define SEGMENT_SIZE 256
+
+/* split a bucket once there are more items than this per bucket */
+#define MAX_LOAD 1.0
+
+typedef struct node_s node_t;
+
+struct node_s
+{
+    void *key;
+    void *val;
+    /* mixed; see __hash */
+    unsigned long hash;
+    node_t *next;
+};
+
+/**
+ * Spread the hash (splitmix64's finaliser). Addressing and splits use its
+ * low bits, which identity-style hashes leave poorly spread */
+static unsigned long __hash(
+    hashmap_linear_t * h,
+    const void *key
+    )
+{
+    unsigned long x = h->hash(key);
+
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9UL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebUL;
+    return x ^ (x >> 31);
+}
+
+/**
+ * @return the chain head for bucket b */
+static node_t **__head(
+    hashmap_linear_t * h,
+    unsigned int b
+    )
+{
+    return (node_t**)&h->segments[b / SEGMENT_SIZE][b % SEGMENT_SIZE];
+}
+
+/**
+ * @return the bucket for this hash */
+static unsigned int __address(
+    hashmap_linear_t * h,
+    unsigned long hash
+    )
+{
+    unsigned int b = hash & (h->nbase - 1);
+
+    /* already split this round: use one more bit */
+    if (b < h->split)
+        b = hash & (h->nbase * 2 - 1);
+    return b;
+}
+
+/**
+ * Make sure bucket b has a segment */
+static void __ensure_segment(
+    hashmap_linear_t * h,
+    unsigned int b
+    )
+{
+    unsigned int seg = b / SEGMENT_SIZE;
+
+    if (h->nsegments <= seg)
+    {
+        unsigned int n = h->nsegments * 2;
+
+        /* only the directory is copied, never the buckets */
+        h->segments = realloc(h->segments, n * sizeof(void**));
+        memset(h->segments + h->nsegments, 0,
+               (n - h->nsegments) * sizeof(void**));
+        h->nsegments = n;
+    }
+
+    if (!h->segments[seg])
+        h->segments[seg] = calloc(SEGMENT_SIZE, sizeof(void*));
+}
+
+/**
+ * Share the split bucket's chain with one new bucket */
+static void __split(
+    hashmap_linear_t * h
+    )
+{
+    unsigned int to = h->nbase + h->split;
+    node_t **from_link, **to_link, *n;
+
+    __ensure_segment(h, to);
+    from_link = __head(h, h->split);
+    to_link = __head(h, to);
+
+    /* the extra bit decides who stays */
+    for (n = *from_link; n; n = *from_link)
+    {
+        if (n->hash & h->nbase)
+        {
+            *from_link = n->next;
+            n->next = NULL;
+            *to_link = n;
+            to_link = &n->next;
+        }
+        else
+            from_link = &n->next;
+    }
+
+    if (++h->split == h->nbase)
+    {
+        h->nbase *= 2;
+        h->split = 0;
+    }
+}
+
+/**
+ * @return link pointing at key's node; otherwise link at the end of the
+ *         chain */
+static node_t **__find(
+    hashmap_linear_t * h,
+    unsigned long hash,
+    const void *key
+    )
+{
+    node_t **link = __head(h, __address(h, hash));
+
+    for (; *link; link = &(*link)->next)
+        if ((*link)->hash == hash && 0 == h->compare(key, (*link)->key))
+            break;
+    return link;
+}
+
+hashmap_linear_t *hashmap_linear_new(
+    func_longhash_f hash,
+    func_longcmp_f cmp,
+    unsigned int initial_capacity
+    )
+{
+    hashmap_linear_t *h = calloc(1, sizeof(hashmap_linear_t));
+    unsigned int ii;
+
+    for (h->nbase = 1; h->nbase * MAX_LOAD < initial_capacity; h->nbase *= 2)
+        ;
+    h->nsegments = (h->nbase + SEGMENT_SIZE - 1) / SEGMENT_SIZE;
+    h->segments = calloc(h->nsegments, sizeof(void**));
+    for (ii = 0; ii < h->nbase; ii += SEGMENT_SIZE)
+        __ensure_segment(h, ii);
+    h->hash = hash;
+    h->compare = cmp;
+    return h;
+}
+
+int hashmap_linear_count(
+    hashmap_linear_t * h
+    )
+{
+    return h->count;
+}
+
+int hashmap_linear_size(
+    hashmap_linear_t * h
+    )
+{
+    return h->nbase + h->split;
+}
+
+void *hashmap_linear_get(
+    hashmap_linear_t * h,
+    const void *key
+    )
+{
+    node_t *n;
+
+    if (0 == h->count || !key || !(n = *__find(h, __hash(h, key), key)))
+        return NULL;
+    return n->val;
+}
+
+int hashmap_linear_contains_key(
+    hashmap_linear_t * h,
+    const void *key
+    )
+{
+    return NULL != hashmap_linear_get(h, key);
+}
+
+void *hashmap_linear_put(
+    hashmap_linear_t * h,
+    void *key,
+    void *val
+    )
+{
+    unsigned long hash;
+    node_t **link, *n;
+
+    if (!key || !val)
+        return NULL;
+
+    hash = __hash(h, key);
+    link = __find(h, hash, key);
+
+    if ((n = *link))
+    {
+        void *val_prev = n->val;
+        n->val = val;
+        return val_prev;
+    }
+
+    n = malloc(sizeof(node_t));
+    n->key = key;
+    n->val = val;
+    n->hash = hash;
+    n->next = NULL;
+    *link = n;
+    h->count++;
+
+    if (hashmap_linear_size(h) * MAX_LOAD < h->count)
+        __split(h);
+
+    return NULL;
+}
+
+void *hashmap_linear_remove(
+    hashmap_linear_t * h,
+    const void *key
+    )
+{
+    node_t **link, *n;
+    void *val;
+
+    if (!key || !(n = *(link = __find(h, __hash(h, key), key))))
+        return NULL;
+
+    *link = n->next;
+    val = n->val;
+    free(n);
+    h->count--;
+    return val;
+}
+
+void hashmap_linear_freeall(
+    hashmap_linear_t * h
+    )
+{
+    unsigned int ii, jj;
+
+    for (ii = 0; ii < h->nsegments; ii++)
+    {
+        if (!h->segments[ii])
+            continue;
+
+        for (jj = 0; jj < SEGMENT_SIZE; jj++)
+        {
+            node_t *n = h->segments[ii][jj];
+
+            while (n)
+            {
+                node_t *next = n->next;
+                free(n);
+                n = next;
+            }
+        }
+        free(h->segments[ii]);
+    }
+
+    free(h->segments);
+    free(h);
+}
+
+/*--------------------------------------------------------------79-characters-*/
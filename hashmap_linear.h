@@ -0,0 +1,90 @@
+#ifndef HASHMAP_LINEAR_H
+#define HASHMAP_LINEAR_H
+
+/**
+ * A chained hashmap using linear hashing, which grows one bucket at a time.
+ *
+ * When the load gets too high, the bucket at the split pointer is split:
+ * its chain is shared out between itself and one new bucket, using one
+ * more bit of the (mixed) hash. The pointer then moves on. Buckets before the
+ * pointer are addressed with that extra bit, and once every bucket has
+ * been split the table has doubled and the pointer starts again.
+ *
+ * Buckets live in fixed-size segments found through a small directory, so
+ * the bucket array is never copied. Each node keeps its key's hash, so a
+ * split calls neither the hash nor the compare function. */
+
+#include "linked_list_hashmap.h"
+
+typedef struct
+{
+    int count;
+    /* buckets before the first split of this round; a power of two */
+    unsigned int nbase;
+    /* next bucket to split */
+    unsigned int split;
+    /* segments of buckets */
+    void ***segments;
+    unsigned int nsegments;
+    func_longhash_f hash;
+    func_longcmp_f compare;
+} hashmap_linear_t;
+
+hashmap_linear_t *hashmap_linear_new(
+    func_longhash_f hash,
+    func_longcmp_f cmp,
+    unsigned int initial_capacity
+);
+
+/**
+ * @return number of items within hash */
+int hashmap_linear_count(
+    hashmap_linear_t * h
+);
+
+/**
+ * @return number of buckets */
+int hashmap_linear_size(
+    hashmap_linear_t * h
+);
+
+/**
+ * Get this key's value.
+ * @return key's item, otherwise NULL */
+void *hashmap_linear_get(
+    hashmap_linear_t * h,
+    const void *key
+);
+
+/**
+ * Is this key inside this map?
+ * @return 1 if key is in hash, otherwise 0 */
+int hashmap_linear_contains_key(
+    hashmap_linear_t * h,
+    const void *key
+);
+
+/**
+ * Associate key with val.
+ * @return previous associated val; otherwise NULL */
+void *hashmap_linear_put(
+    hashmap_linear_t * h,
+    void *key,
+    void *val
+);
+
+/**
+ * Remove this key and value from the map.
+ * @return value of key, or NULL on failure */
+void *hashmap_linear_remove(
+    hashmap_linear_t * h,
+    const void *key
+);
+
+/**
+ * Free all the memory related to this hash. */
+void hashmap_linear_freeall(
+    hashmap_linear_t * h
+);
+
+#endif /* HASHMAP_LINEAR_H */
@@ -0,0 +1,248 @@
+/*
+
+   Copyright (c) 2011, Willem-Hendrik Thiart
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+ * The names of its contributors may not be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+   ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+   WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL WILLEM-HENDRIK THIART BE LIABLE FOR ANY
+   DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+   (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+   LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+   ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+
+#include "linked_list_hashmap.h"
+#include "hashmap_mph.h"
+
+/* average keys per bucket */
+#define BUCKET_SIZE 5
+
+/* give up on a bucket after this many seeds */
+#define MAX_SEED (1u << 26)
+
+/**
+ * Derive an independent hash for each seed (splitmix64's finaliser) */
+static uint64_t __mix(
+    unsigned long hash,
+    unsigned int seed
+    )
+{
+    uint64_t x = hash + (seed + 1) * 0x9e3779b97f4a7c15ULL;
+
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+static unsigned int __bucket(
+    const hashmap_mph_t * m,
+    unsigned long hash
+    )
+{
+    /* seed 0 places keys in buckets; bucket seeds start at 1 */
+    return __mix(hash, 0) % m->nbuckets;
+}
+
+static unsigned int __slot(
+    const hashmap_mph_t * m,
+    unsigned long hash,
+    unsigned int seed
+    )
+{
+    return __mix(hash, seed) % m->count;
+}
+
+/**
+ * Find a seed that sends every key in the bucket to a free slot, and take
+ * those slots.
+ * @param keys : indexes into hashes of the bucket's keys
+ * @return the seed; 0 if there is none */
+static unsigned int __place(
+    const hashmap_mph_t * m,
+    const unsigned long *hashes,
+    const unsigned int *keys,
+    unsigned int n,
+    unsigned char *taken,
+    unsigned int *slots
+    )
+{
+    unsigned int seed, ii, jj;
+
+    /* keys with the same hash go to the same slot, whatever the seed */
+    for (ii = 0; ii < n; ii++)
+        for (jj = ii + 1; jj < n; jj++)
+            if (hashes[keys[ii]] == hashes[keys[jj]])
+                return 0;
+
+    for (seed = 1; seed < MAX_SEED; seed++)
+    {
+        for (ii = 0; ii < n; ii++)
+        {
+            slots[ii] = __slot(m, hashes[keys[ii]], seed);
+            if (taken[slots[ii]])
+                break;
+            /* claim it now, so the bucket's own keys can't share it */
+            taken[slots[ii]] = 1;
+        }
+
+        if (ii == n)
+            return seed;
+
+        while (ii--)
+            taken[slots[ii]] = 0;
+    }
+
+    return 0;
+}
+
+hashmap_mph_t *hashmap_mph_build(
+    hashmap_t * h
+    )
+{
+    hashmap_mph_t *m;
+    hashmap_iterator_t iter;
+    hashmap_entry_t *etys;
+    unsigned long *hashes;
+    unsigned int *start, *keys, *order, *by_size, *slots;
+    unsigned char *taken;
+    unsigned int ii, n = hashmap_count(h), max = 0;
+
+    m = calloc(1, sizeof(hashmap_mph_t));
+    m->count = n;
+    m->nbuckets = n / BUCKET_SIZE + 1;
+    m->seeds = calloc(m->nbuckets, sizeof(unsigned int));
+    m->entries = malloc(n * sizeof(hashmap_entry_t) + 1);
+    m->hash = h->hash;
+    m->compare = h->compare;
+
+    etys = malloc(n * sizeof(hashmap_entry_t) + 1);
+    hashes = malloc(n * sizeof(unsigned long) + 1);
+    hashmap_iterator(h, &iter);
+    for (ii = 0; ii < n; ii++)
+    {
+        etys[ii].key = hashmap_iterator_next(h, &iter);
+        etys[ii].val = hashmap_get(h, etys[ii].key);
+        hashes[ii] = h->hash(etys[ii].key);
+    }
+
+    /* group the keys by bucket: bucket b has keys[start[b]..start[b + 1]] */
+    start = calloc(m->nbuckets + 1, sizeof(unsigned int));
+    keys = malloc(n * sizeof(unsigned int) + 1);
+    for (ii = 0; ii < n; ii++)
+        start[__bucket(m, hashes[ii]) + 1]++;
+    for (ii = 0; ii < m->nbuckets; ii++)
+    {
+        if (max < start[ii + 1])
+            max = start[ii + 1];
+        start[ii + 1] += start[ii];
+    }
+    for (ii = 0; ii < n; ii++)
+        keys[start[__bucket(m, hashes[ii])]++] = ii;
+    /* each start has moved on to the next bucket's */
+    memmove(start + 1, start, m->nbuckets * sizeof(unsigned int));
+    start[0] = 0;
+
+    /* the biggest buckets are hardest to place, so go first */
+    by_size = calloc(max + 2, sizeof(unsigned int));
+    order = malloc(m->nbuckets * sizeof(unsigned int));
+    for (ii = 0; ii < m->nbuckets; ii++)
+        by_size[max - (start[ii + 1] - start[ii]) + 1]++;
+    for (ii = 0; ii <= max; ii++)
+        by_size[ii + 1] += by_size[ii];
+    for (ii = 0; ii < m->nbuckets; ii++)
+        order[by_size[max - (start[ii + 1] - start[ii])]++] = ii;
+
+    taken = calloc(n + 1, 1);
+    slots = malloc((max + 1) * sizeof(unsigned int));
+    for (ii = 0; ii < m->nbuckets; ii++)
+    {
+        unsigned int b = order[ii], size = start[b + 1] - start[b], jj;
+
+        if (0 == size)
+            break;
+
+        m->seeds[b] = __place(m, hashes, keys + start[b], size, taken, slots);
+        if (0 == m->seeds[b])
+        {
+            hashmap_mph_free(m);
+            m = NULL;
+            break;
+        }
+
+        for (jj = 0; jj < size; jj++)
+            m->entries[slots[jj]] = etys[keys[start[b] + jj]];
+    }
+
+    free(etys);
+    free(hashes);
+    free(start);
+    free(keys);
+    free(by_size);
+    free(order);
+    free(taken);
+    free(slots);
+    return m;
+}
+
+int hashmap_mph_count(
+    const hashmap_mph_t * m
+    )
+{
+    return m->count;
+}
+
+void *hashmap_mph_get(
+    const hashmap_mph_t * m,
+    const void *key
+    )
+{
+    unsigned long hash;
+    hashmap_entry_t *e;
+
+    if (0 == m->count || !key)
+        return NULL;
+
+    hash = m->hash(key);
+    e = &m->entries[__slot(m, hash, m->seeds[__bucket(m, hash)])];
+    return 0 == m->compare(key, e->key) ? e->val : NULL;
+}
+
+int hashmap_mph_contains_key(
+    const hashmap_mph_t * m,
+    const void *key
+    )
+{
+    return NULL != hashmap_mph_get(m, key);
+}
+
+void hashmap_mph_free(
+    hashmap_mph_t * m
+    )
+{
+    free(m->seeds);
+    free(m->entries);
+    free(m);
+}
+
+/*--------------------------------------------------------------79-characters-*/
@@ -0,0 +1,63 @@
+#ifndef HASHMAP_MPH_H
+#define HASHMAP_MPH_H
+
+/**
+ * A minimal perfect hash table, built from a hashmap_t whose keys won't
+ * change: every key has a slot of its own, and there are no empty slots.
+ * A lookup is one probe and one compare.
+ *
+ * Built by hash and displace: keys are spread over small buckets, and each
+ * bucket gets a seed that sends its keys to free slots. The seeds cost
+ * about six bits per key.
+ *
+ * Slots are derived from the map's hash function, so no two keys may hash
+ * to the same value. */
+
+#include "linked_list_hashmap.h"
+
+typedef struct
+{
+    int count;
+    unsigned int nbuckets;
+    unsigned int *seeds;
+    hashmap_entry_t *entries;
+    func_longhash_f hash;
+    func_longcmp_f compare;
+} hashmap_mph_t;
+
+/**
+ * Build a table holding the same entries as hmap. hmap is left as it is.
+ * @return the table; NULL if two keys have the same hash */
+hashmap_mph_t *hashmap_mph_build(
+    hashmap_t * hmap
+);
+
+/**
+ * @return number of items within the table */
+int hashmap_mph_count(
+    const hashmap_mph_t * m
+);
+
+/**
+ * Get this key's value.
+ * @return key's item, otherwise NULL */
+void *hashmap_mph_get(
+    const hashmap_mph_t * m,
+    const void *key
+);
+
+/**
+ * Is this key inside this table?
+ * @return 1 if key is in hash, otherwise 0 */
+int hashmap_mph_contains_key(
+    const hashmap_mph_t * m,
+    const void *key
+);
+
+/**
+ * Free the table. Keys and values are left alone. */
+void hashmap_mph_free(
+    hashmap_mph_t * m
+);
+
+#endif /* HASHMAP_MPH_H */
@@ -0,0 +1,236 @@
+/*
+
+   Copyright (c) 2011, Willem-Hendrik Thiart
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+ * The names of its contributors may not be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+   ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+   WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL WILLEM-HENDRIK THIART BE LIABLE FOR ANY
+   DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+   (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+   LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+   ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+
+#include "linked_list_hashmap.h"
+#include "hashmap_parallel.h"
+
+/* blocks dealt to each thread; more blocks make stealing finer grained */
+#define BLOCKS_PER_THREAD 64
+
+typedef struct worker_s worker_t;
+
+typedef struct
+{
+    hashmap_t *h;
+    int nworkers;
+    worker_t *workers;
+    int block_len;
+} pool_t;
+
+struct worker_s
+{
+    pool_t *pool;
+    int id;
+    pthread_t thread;
+    /* blocks still to do: [lo, hi) */
+    pthread_mutex_t lock;
+    int lo, hi;
+    hashmap_scan_f fn;
+    void *udata;
+    /* for reductions */
+    hashmap_fold_f fold;
+    void *fold_udata;
+    void *acc;
+};
+
+/**
+ * Take a block from our own range, or steal half of somebody else's.
+ * @return block index; -1 if there is no work left anywhere */
+static int __next_block(worker_t * w)
+{
+    pool_t *p = w->pool;
+    int ii, b = -1;
+
+    pthread_mutex_lock(&w->lock);
+    if (w->lo < w->hi)
+        b = w->lo++;
+    pthread_mutex_unlock(&w->lock);
+
+    if (0 <= b)
+        return b;
+
+    /* Work only moves between ranges by stealing, so once every range has
+     * been seen empty there is nothing left for us */
+    for (ii = 1; ii < p->nworkers; ii++)
+    {
+        worker_t *v = &p->workers[(w->id + ii) % p->nworkers];
+        int n, from;
+
+        pthread_mutex_lock(&v->lock);
+        n = (v->hi - v->lo + 1) / 2;
+        from = v->hi - n;
+        v->hi = from;
+        pthread_mutex_unlock(&v->lock);
+
+        if (0 == n)
+            continue;
+
+        /* keep the first stolen block, and make the rest stealable */
+        pthread_mutex_lock(&w->lock);
+        w->lo = from + 1;
+        w->hi = from + n;
+        pthread_mutex_unlock(&w->lock);
+        return from;
+    }
+
+    return -1;
+}
+
+static void *__work(void *arg)
+{
+    worker_t *w = arg;
+    pool_t *p = w->pool;
+    int b;
+
+    while (0 <= (b = __next_block(w)))
+        hashmap_foreach_range(p->h, b * p->block_len, (b + 1) * p->block_len,
+                              w->fn, w->udata);
+
+    return NULL;
+}
+
+static void __fold_entry(void *udata, void *key, void *val)
+{
+    worker_t *w = udata;
+    w->acc = w->fold(w->fold_udata, w->acc, key, val);
+}
+
+/**
+ * Deal the blocks out, run every worker, and wait for them to finish.
+ * The workers' callbacks must be set up by the caller. */
+static void __run(pool_t * p)
+{
+    int ii, nblocks;
+
+    nblocks = p->nworkers * BLOCKS_PER_THREAD;
+    if (hashmap_size(p->h) < nblocks)
+        nblocks = hashmap_size(p->h);
+    p->block_len = (hashmap_size(p->h) + nblocks - 1) / nblocks;
+    nblocks = (hashmap_size(p->h) + p->block_len - 1) / p->block_len;
+
+    for (ii = 0; ii < p->nworkers; ii++)
+    {
+        worker_t *w = &p->workers[ii];
+
+        w->pool = p;
+        w->id = ii;
+        w->lo = (long)nblocks * ii / p->nworkers;
+        w->hi = (long)nblocks * (ii + 1) / p->nworkers;
+        pthread_mutex_init(&w->lock, NULL);
+    }
+
+    /* the calling thread is worker 0 */
+    for (ii = 1; ii < p->nworkers; ii++)
+        pthread_create(&p->workers[ii].thread, NULL, __work, &p->workers[ii]);
+    __work(&p->workers[0]);
+    for (ii = 1; ii < p->nworkers; ii++)
+        pthread_join(p->workers[ii].thread, NULL);
+
+    for (ii = 0; ii < p->nworkers; ii++)
+        pthread_mutex_destroy(&p->workers[ii].lock);
+}
+
+void hashmap_parallel_foreach(
+    hashmap_t * h,
+    hashmap_scan_f fn,
+    void *udata,
+    int nthreads
+    )
+{
+    pool_t p;
+    int ii;
+
+    assert(0 < nthreads);
+
+    /* no buckets to deal out */
+    if (0 == hashmap_size(h))
+        return;
+
+    p.h = h;
+    p.nworkers = nthreads;
+    p.workers = calloc(nthreads, sizeof(worker_t));
+
+    for (ii = 0; ii < nthreads; ii++)
+    {
+        p.workers[ii].fn = fn;
+        p.workers[ii].udata = udata;
+    }
+
+    __run(&p);
+    free(p.workers);
+}
+
+void *hashmap_parallel_reduce(
+    hashmap_t * h,
+    hashmap_fold_f fold,
+    hashmap_combine_f combine,
+    void *init,
+    void *udata,
+    int nthreads
+    )
+{
+    pool_t p;
+    void *acc;
+    int ii;
+
+    assert(0 < nthreads);
+
+    if (0 == hashmap_size(h))
+        return init;
+
+    p.h = h;
+    p.nworkers = nthreads;
+    p.workers = calloc(nthreads, sizeof(worker_t));
+
+    for (ii = 0; ii < nthreads; ii++)
+    {
+        worker_t *w = &p.workers[ii];
+
+        w->fn = __fold_entry;
+        w->udata = w;
+        w->fold = fold;
+        w->fold_udata = udata;
+        w->acc = init;
+    }
+
+    __run(&p);
+
+    acc = p.workers[0].acc;
+    for (ii = 1; ii < nthreads; ii++)
+        acc = combine(udata, acc, p.workers[ii].acc);
+
+    free(p.workers);
+    return acc;
+}
+
+/*--------------------------------------------------------------79-characters-*/
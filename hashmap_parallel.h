@@ -0,0 +1,51 @@
+#ifndef HASHMAP_PARALLEL_H
+#define HASHMAP_PARALLEL_H
+
+/**
+ * Parallel traversal of a hashmap_t.
+ *
+ * The bucket array is cut into blocks, which are dealt out to a small pool
+ * of threads. A thread that runs out of blocks steals half of the remaining
+ * blocks of another thread, so a few long chains don't leave the rest of
+ * the pool idle. Entries are read in place; nothing is copied.
+ *
+ * The map must not be changed while a traversal is running. */
+
+#include "linked_list_hashmap.h"
+
+/**
+ * Fold one entry into an accumulator.
+ * @return the new accumulator */
+typedef void *(*hashmap_fold_f) (void *udata, void *acc, void *key, void *val);
+
+/**
+ * Combine two accumulators.
+ * @return the combined accumulator */
+typedef void *(*hashmap_combine_f) (void *udata, void *acc1, void *acc2);
+
+/**
+ * Call fn on every entry, from nthreads threads at once.
+ * The calling thread is one of them. */
+void hashmap_parallel_foreach(
+    hashmap_t * hmap,
+    hashmap_scan_f fn,
+    void *udata,
+    int nthreads
+);
+
+/**
+ * Fold every entry into an accumulator, from nthreads threads at once.
+ * Each thread starts its own accumulator at init, so init must be an
+ * identity for combine. The per-thread accumulators are combined at the
+ * end, on the calling thread.
+ * @return the combined accumulator */
+void *hashmap_parallel_reduce(
+    hashmap_t * hmap,
+    hashmap_fold_f fold,
+    hashmap_combine_f combine,
+    void *init,
+    void *udata,
+    int nthreads
+);
+
+#endif /* HASHMAP_PARALLEL_H */
@@ -0,0 +1,374 @@
+/*
+
+   Copyright (c) 2011, Willem-Hendrik Thiart
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+ * The names of its contributors may not be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+   ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+   WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL WILLEM-HENDRIK THIART BE LIABLE FOR ANY
+   DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+   (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+   LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+   ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+
+#include "linked_list_hashmap.h"
+#include "hashmap_seqlock.h"
+
+/* grow a stripe before its hashmap_t would grow itself in place */
+#define STRIPE_SPACERATIO 0.25
+
+#define CACHE_LINE 64
+
+typedef struct retired_s retired_t;
+
+struct retired_s
+{
+    retired_t *next;
+    hashmap_t *map;
+};
+
+typedef struct
+{
+    /* odd while a writer is inside the stripe */
+    unsigned int seq;
+    hashmap_t *map;
+    pthread_mutex_t lock;
+    /* outgrown maps that readers may still be looking at */
+    retired_t *retired;
+} __attribute__((aligned(CACHE_LINE))) stripe_t;
+
+static int __stripe_idx(hashmap_seqlock_t * h, const void *key)
+{
+    unsigned long hv = h->hash(key);
+
+    /* the stripe maps probe on the low bits, so select on all bits */
+    hv ^= hv >> 16;
+    hv *= 0x45d9f3bUL;
+    hv ^= hv >> 16;
+    return hv % h->nstripes;
+}
+
+static stripe_t *__stripe(hashmap_seqlock_t * h, const void *key)
+{
+    return &((stripe_t*)h->stripes)[__stripe_idx(h, key)];
+}
+
+hashmap_seqlock_t *hashmap_seqlock_new(
+    func_longhash_f hash,
+    func_longcmp_f cmp,
+    unsigned int initial_capacity,
+    unsigned int nstripes
+    )
+{
+    hashmap_seqlock_t *h;
+    void *stripes;
+    unsigned int ii, cap;
+
+    assert(0 < nstripes);
+
+    if (0 != posix_memalign(&stripes, CACHE_LINE, nstripes * sizeof(stripe_t)))
+        return NULL;
+    memset(stripes, 0, nstripes * sizeof(stripe_t));
+
+    h = calloc(1, sizeof(hashmap_seqlock_t));
+    h->nstripes = nstripes;
+    h->stripes = stripes;
+    h->hash = hash;
+    h->compare = cmp;
+
+    cap = initial_capacity / nstripes;
+    if (cap < 4)
+        cap = 4;
+
+    for (ii = 0; ii < nstripes; ii++)
+    {
+        stripe_t *s = &((stripe_t*)stripes)[ii];
+        s->map = hashmap_new(hash, cmp, cap);
+        pthread_mutex_init(&s->lock, NULL);
+    }
+
+    return h;
+}
+
+int hashmap_seqlock_count(hashmap_seqlock_t * h)
+{
+    int ii, count = 0;
+
+    for (ii = 0; ii < h->nstripes; ii++)
+    {
+        stripe_t *s = &((stripe_t*)h->stripes)[ii];
+        hashmap_t *m = __atomic_load_n(&s->map, __ATOMIC_ACQUIRE);
+        count += __atomic_load_n(&m->count, __ATOMIC_RELAXED);
+    }
+
+    return count;
+}
+
+static void __write_begin(stripe_t * s)
+{
+    pthread_mutex_lock(&s->lock);
+    __atomic_store_n(&s->seq, s->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static void __write_end(stripe_t * s)
+{
+    __atomic_store_n(&s->seq, s->seq + 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&s->lock);
+}
+
+void *hashmap_seqlock_get(hashmap_seqlock_t * h, const void *key)
+{
+    stripe_t *s;
+
+    if (!key)
+        return NULL;
+
+    s = __stripe(h, key);
+
+    while (1)
+    {
+        unsigned int seq = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+
+        /* a writer is inside the stripe */
+        if (seq & 1)
+            continue;
+
+        hashmap_t *m = __atomic_load_n(&s->map, __ATOMIC_ACQUIRE);
+        void *val = hashmap_get(m, key);
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (seq == __atomic_load_n(&s->seq, __ATOMIC_RELAXED))
+            return val;
+    }
+}
+
+int hashmap_seqlock_contains_key(hashmap_seqlock_t * h, const void *key)
+{
+    return NULL != hashmap_seqlock_get(h, key);
+}
+
+/**
+ * Make room for one more item without the stripe map resizing in place.
+ * The old map is retired, not freed, because readers may be inside it.
+ * Must be called within __write_begin/__write_end. */
+static void __stripe_ensurecapacity(hashmap_seqlock_t * h, stripe_t * s)
+{
+    hashmap_t *old = s->map, *m;
+    hashmap_iterator_t iter;
+    retired_t *r;
+    void *key;
+
+    if ((float)(hashmap_count(old) + 1) / hashmap_size(old) < STRIPE_SPACERATIO)
+        return;
+
+    m = hashmap_new(h->hash, h->compare, hashmap_size(old) * 2);
+
+    hashmap_iterator(old, &iter);
+    while ((key = hashmap_iterator_next(old, &iter)))
+        hashmap_put(m, key, hashmap_get(old, key));
+
+    __atomic_store_n(&s->map, m, __ATOMIC_RELEASE);
+
+    r = malloc(sizeof(retired_t));
+    r->map = old;
+    r->next = s->retired;
+    s->retired = r;
+}
+
+void *hashmap_seqlock_put(hashmap_seqlock_t * h, void *key, void *val)
+{
+    stripe_t *s;
+    void *prev;
+
+    if (!key || !val)
+        return NULL;
+
+    s = __stripe(h, key);
+    __write_begin(s);
+    __stripe_ensurecapacity(h, s);
+    prev = hashmap_put(s->map, key, val);
+    __write_end(s);
+    return prev;
+}
+
+void hashmap_seqlock_put_batch(
+    hashmap_seqlock_t * h,
+    hashmap_entry_t * entries,
+    int n,
+    hashmap_merge_f merge,
+    void *udata
+    )
+{
+    int *idx, *order, *start, ii;
+
+    if (0 == n)
+        return;
+
+    /* counting sort the entries by stripe */
+    idx = malloc(n * sizeof(int));
+    order = malloc(n * sizeof(int));
+    start = calloc(h->nstripes + 1, sizeof(int));
+
+    for (ii = 0; ii < n; ii++)
+    {
+        idx[ii] = __stripe_idx(h, entries[ii].key);
+        start[idx[ii] + 1]++;
+    }
+    for (ii = 0; ii < h->nstripes; ii++)
+        start[ii + 1] += start[ii];
+    for (ii = 0; ii < n; ii++)
+        order[start[idx[ii]]++] = ii;
+
+    /* start[s] is now where stripe s's entries end */
+    for (ii = 0; ii < h->nstripes; ii++)
+    {
+        stripe_t *s = &((stripe_t*)h->stripes)[ii];
+        int jj = 0 == ii ? 0 : start[ii - 1];
+
+        if (jj == start[ii])
+            continue;
+
+        __write_begin(s);
+        for (; jj < start[ii]; jj++)
+        {
+            hashmap_entry_t *e = &entries[order[jj]];
+            void *prev;
+
+            if (!e->key || !e->val)
+                continue;
+
+            __stripe_ensurecapacity(h, s);
+            if (!merge)
+                hashmap_put(s->map, e->key, e->val);
+            else if ((prev = hashmap_put_if_absent(s->map, e->key, e->val)))
+                hashmap_put(s->map, e->key, merge(udata, prev, e->val));
+        }
+        __write_end(s);
+    }
+
+    free(idx);
+    free(order);
+    free(start);
+}
+
+void *hashmap_seqlock_remove(hashmap_seqlock_t * h, const void *key)
+{
+    stripe_t *s;
+    void *val;
+
+    if (!key)
+        return NULL;
+
+    s = __stripe(h, key);
+    __write_begin(s);
+    val = hashmap_remove(s->map, key);
+    __write_end(s);
+    return val;
+}
+
+void *hashmap_seqlock_put_if_absent(
+    hashmap_seqlock_t * h,
+    void *key,
+    void *val
+    )
+{
+    stripe_t *s;
+    void *prev;
+
+    if (!key || !val)
+        return NULL;
+
+    s = __stripe(h, key);
+    __write_begin(s);
+    __stripe_ensurecapacity(h, s);
+    prev = hashmap_put_if_absent(s->map, key, val);
+    __write_end(s);
+    return prev;
+}
+
+int hashmap_seqlock_replace_if(
+    hashmap_seqlock_t * h,
+    const void *key,
+    const void *expected,
+    void *val_new
+    )
+{
+    stripe_t *s;
+    int replaced;
+
+    if (!key)
+        return 0;
+
+    s = __stripe(h, key);
+    __write_begin(s);
+    replaced = hashmap_replace_if(s->map, key, expected, val_new);
+    __write_end(s);
+    return replaced;
+}
+
+int hashmap_seqlock_remove_if(
+    hashmap_seqlock_t * h,
+    const void *key,
+    const void *expected
+    )
+{
+    stripe_t *s;
+    int removed;
+
+    if (!key)
+        return 0;
+
+    s = __stripe(h, key);
+    __write_begin(s);
+    removed = hashmap_remove_if(s->map, key, expected);
+    __write_end(s);
+    return removed;
+}
+
+void hashmap_seqlock_freeall(hashmap_seqlock_t * h)
+{
+    int ii;
+
+    for (ii = 0; ii < h->nstripes; ii++)
+    {
+        stripe_t *s = &((stripe_t*)h->stripes)[ii];
+
+        while (s->retired)
+        {
+            retired_t *r = s->retired;
+            s->retired = r->next;
+            hashmap_freeall(r->map);
+            free(r);
+        }
+
+        hashmap_freeall(s->map);
+        pthread_mutex_destroy(&s->lock);
+    }
+
+    free(h->stripes);
+    free(h);
+}
+
+/*--------------------------------------------------------------79-characters-*/
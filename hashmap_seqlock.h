@@ -0,0 +1,127 @@
+#ifndef HASHMAP_SEQLOCK_H
+#define HASHMAP_SEQLOCK_H
+
+/**
+ * A hashmap for read-mostly concurrent use.
+ *
+ * Keys are spread over stripes. Each stripe owns a hashmap_t, a writer lock
+ * and a sequence counter. Writers take the stripe lock and bump the counter
+ * around the normal put/remove logic. Readers take no lock: they read
+ * optimistically and retry if the counter moved underneath them.
+ *
+ * Memory that a reader may still be looking at is not given back until the
+ * map is freed: chain nodes are recycled within their stripe, and the arrays
+ * of outgrown stripe maps are retired rather than freed. Keys removed from
+ * the map must stay readable by the compare function for the same reason. */
+
+#include "linked_list_hashmap.h"
+
+/**
+ * Combine the value already in the map with a new one.
+ * @return value to store */
+typedef void *(*hashmap_merge_f) (void *udata, void *val_old, void *val_new);
+
+typedef struct
+{
+    int nstripes;
+    void *stripes;
+    func_longhash_f hash;
+    func_longcmp_f compare;
+} hashmap_seqlock_t;
+
+/**
+ * @param nstripes : number of independently locked stripes */
+hashmap_seqlock_t *hashmap_seqlock_new(
+    func_longhash_f hash,
+    func_longcmp_f cmp,
+    unsigned int initial_capacity,
+    unsigned int nstripes
+);
+
+/**
+ * @return number of items within hash */
+int hashmap_seqlock_count(
+    hashmap_seqlock_t * h
+);
+
+/**
+ * Get this key's value without taking a lock.
+ * @return key's item, otherwise NULL */
+void *hashmap_seqlock_get(
+    hashmap_seqlock_t * h,
+    const void *key
+);
+
+/**
+ * Is this key inside this map?
+ * @return 1 if key is in hash, otherwise 0 */
+int hashmap_seqlock_contains_key(
+    hashmap_seqlock_t * h,
+    const void *key
+);
+
+/**
+ * Associate key with val.
+ * @return previous associated val; otherwise NULL */
+void *hashmap_seqlock_put(
+    hashmap_seqlock_t * h,
+    void *key,
+    void *val
+);
+
+/**
+ * Remove this key and value from the map.
+ * @return value of key, or NULL on failure */
+void *hashmap_seqlock_remove(
+    hashmap_seqlock_t * h,
+    const void *key
+);
+
+/**
+ * Put many entries, taking each stripe's lock only once.
+ * @param merge : if not NULL, an existing value is replaced by
+ *                merge(udata, existing, new) rather than by new */
+void hashmap_seqlock_put_batch(
+    hashmap_seqlock_t * h,
+    hashmap_entry_t * entries,
+    int n,
+    hashmap_merge_f merge,
+    void *udata
+);
+
+/**
+ * Associate key with val, unless an equal key exists.
+ * @return val already associated with key; otherwise NULL */
+void *hashmap_seqlock_put_if_absent(
+    hashmap_seqlock_t * h,
+    void *key,
+    void *val
+);
+
+/**
+ * Associate key with val_new, if key is currently associated with expected.
+ * @return 1 if replaced, otherwise 0 */
+int hashmap_seqlock_replace_if(
+    hashmap_seqlock_t * h,
+    const void *key,
+    const void *expected,
+    void *val_new
+);
+
+/**
+ * Remove key, if it is currently associated with expected.
+ * @return 1 if removed, otherwise 0 */
+int hashmap_seqlock_remove_if(
+    hashmap_seqlock_t * h,
+    const void *key,
+    const void *expected
+);
+
+/**
+ * Free all the memory related to this hash.
+ * No other thread may be using the map. */
+void hashmap_seqlock_freeall(
+    hashmap_seqlock_t * h
+);
+
+#endif /* HASHMAP_SEQLOCK_H */
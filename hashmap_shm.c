@@ -0,0 +1,322 @@
+/*
+
+   Copyright (c) 2011, Willem-Hendrik Thiart
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+ * The names of its contributors may not be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+   ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+   WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL WILLEM-HENDRIK THIART BE LIABLE FOR ANY
+   DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+   (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+   LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+   ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "hashmap_shm.h"
+
+#define SHM_MAGIC 0x4c4c484d53484d31ULL
+
+/* offset 0 is the header, so no entry lives there */
+#define NIL 0
+
+typedef struct
+{
+    uint64_t magic;
+    uint64_t size;
+    uint64_t nbuckets;
+    uint64_t count;
+    /* where the next entry goes */
+    uint64_t used;
+    /* then the buckets: nbuckets offsets of the first entry on each chain */
+    uint64_t buckets[];
+} header_t;
+
+/* followed by the key, then the value */
+typedef struct
+{
+    uint64_t next;
+    uint64_t hash;
+    uint64_t klen;
+    uint64_t vlen;
+} entry_t;
+
+/**
+ * FNV-1a */
+static uint64_t __hash(
+    const void *key,
+    size_t len
+    )
+{
+    const unsigned char *p = key;
+    uint64_t hash = 14695981039346656037ULL;
+
+    while (len--)
+        hash = (hash ^ *p++) * 1099511628211ULL;
+    return hash;
+}
+
+static header_t *__header(
+    hashmap_shm_t * m
+    )
+{
+    return m->base;
+}
+
+static entry_t *__entry(
+    hashmap_shm_t * m,
+    uint64_t off
+    )
+{
+    return (entry_t*)((char*)m->base + off);
+}
+
+static uint64_t __load(
+    const uint64_t * p
+    )
+{
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static void __publish(
+    uint64_t * p,
+    uint64_t v
+    )
+{
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+/**
+ * @return offset of this key's entry; otherwise NIL */
+static uint64_t __find(
+    hashmap_shm_t * m,
+    uint64_t hash,
+    const void *key,
+    size_t klen
+    )
+{
+    header_t *hd = __header(m);
+    uint64_t off;
+
+    for (off = __load(&hd->buckets[hash % hd->nbuckets]); NIL != off;
+         off = __load(&__entry(m, off)->next))
+    {
+        entry_t *e = __entry(m, off);
+
+        if (e->hash == hash && e->klen == klen &&
+            0 == memcmp(e + 1, key, klen))
+            return off;
+    }
+
+    return NIL;
+}
+
+/**
+ * Take the entry at off out of its chain. Readers already past the link
+ * carry on from the entry, which stays as it is. Writer only. */
+static void __unlink(
+    hashmap_shm_t * m,
+    uint64_t *head,
+    uint64_t off
+    )
+{
+    uint64_t *link = head;
+
+    while (*link != off)
+        link = &__entry(m, *link)->next;
+    __publish(link, __entry(m, off)->next);
+}
+
+static hashmap_shm_t *__map(
+    int fd,
+    size_t size,
+    int writable
+    )
+{
+    hashmap_shm_t *m;
+    void *base;
+
+    base = mmap(NULL, size, writable ? PROT_READ | PROT_WRITE : PROT_READ,
+                MAP_SHARED | (-1 == fd ? MAP_ANONYMOUS : 0), fd, 0);
+    if (MAP_FAILED == base)
+        return NULL;
+
+    m = malloc(sizeof(hashmap_shm_t));
+    m->base = base;
+    m->size = size;
+    m->writable = writable;
+    return m;
+}
+
+hashmap_shm_t *hashmap_shm_create(
+    int fd,
+    size_t size,
+    unsigned int nbuckets
+    )
+{
+    hashmap_shm_t *m;
+    header_t *hd;
+
+    if (0 == nbuckets ||
+        size < sizeof(header_t) + nbuckets * sizeof(uint64_t))
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    if (-1 != fd && 0 != ftruncate(fd, size))
+        return NULL;
+
+    if (!(m = __map(fd, size, 1)))
+        return NULL;
+
+    /* a new region is zeroed, so every bucket is already NIL */
+    hd = __header(m);
+    hd->size = size;
+    hd->nbuckets = nbuckets;
+    hd->used = sizeof(header_t) + nbuckets * sizeof(uint64_t);
+    __publish(&hd->magic, SHM_MAGIC);
+    return m;
+}
+
+hashmap_shm_t *hashmap_shm_attach(
+    int fd
+    )
+{
+    hashmap_shm_t *m;
+    struct stat st;
+
+    if (0 != fstat(fd, &st) || (size_t)st.st_size < sizeof(header_t))
+        return NULL;
+
+    if (!(m = __map(fd, st.st_size, 0)))
+        return NULL;
+
+    if (SHM_MAGIC != __load(&__header(m)->magic) ||
+        __header(m)->size != (uint64_t)st.st_size)
+    {
+        hashmap_shm_detach(m);
+        errno = EINVAL;
+        return NULL;
+    }
+
+    return m;
+}
+
+void hashmap_shm_detach(
+    hashmap_shm_t * m
+    )
+{
+    munmap(m->base, m->size);
+    free(m);
+}
+
+int hashmap_shm_count(
+    hashmap_shm_t * m
+    )
+{
+    return __load(&__header(m)->count);
+}
+
+const void *hashmap_shm_get(
+    hashmap_shm_t * m,
+    const void *key,
+    size_t klen,
+    size_t *vlen
+    )
+{
+    uint64_t off = __find(m, __hash(key, klen), key, klen);
+    entry_t *e;
+
+    if (NIL == off)
+        return NULL;
+
+    e = __entry(m, off);
+    if (vlen)
+        *vlen = e->vlen;
+    return (char*)(e + 1) + e->klen;
+}
+
+int hashmap_shm_put(
+    hashmap_shm_t * m,
+    const void *key,
+    size_t klen,
+    const void *val,
+    size_t vlen
+    )
+{
+    header_t *hd = __header(m);
+    uint64_t hash = __hash(key, klen), off, old, *head;
+    size_t len = (sizeof(entry_t) + klen + vlen + 7) & ~(size_t)7;
+    entry_t *e;
+
+    if (!m->writable || hd->size - hd->used < len)
+    {
+        errno = m->writable ? ENOMEM : EPERM;
+        return -1;
+    }
+
+    old = __find(m, hash, key, klen);
+    head = &hd->buckets[hash % hd->nbuckets];
+
+    /* fill the entry in before anyone can reach it */
+    off = hd->used;
+    hd->used += len;
+    e = __entry(m, off);
+    e->next = *head;
+    e->hash = hash;
+    e->klen = klen;
+    e->vlen = vlen;
+    memcpy(e + 1, key, klen);
+    memcpy((char*)(e + 1) + klen, val, vlen);
+    __publish(head, off);
+
+    /* readers now find the new entry first; retire the old one */
+    if (NIL != old)
+        __unlink(m, head, old);
+    else
+        __publish(&hd->count, hd->count + 1);
+
+    return 0;
+}
+
+int hashmap_shm_remove(
+    hashmap_shm_t * m,
+    const void *key,
+    size_t klen
+    )
+{
+    header_t *hd = __header(m);
+    uint64_t hash = __hash(key, klen), off;
+
+    if (!m->writable || NIL == (off = __find(m, hash, key, klen)))
+        return 0;
+
+    __unlink(m, &hd->buckets[hash % hd->nbuckets], off);
+    __publish(&hd->count, hd->count - 1);
+    return 1;
+}
+
+/*--------------------------------------------------------------79-characters-*/
@@ -0,0 +1,88 @@
+#ifndef HASHMAP_SHM_H
+#define HASHMAP_SHM_H
+
+/**
+ * A hashmap that lives in one shared memory region, so that several
+ * processes can read the same entries without copying them.
+ *
+ * Links inside the region are offsets from its start, not pointers, so each
+ * process may map it at any address. For the same reason keys and values
+ * are byte strings stored in the region, and the hash function is built in.
+ *
+ * One process writes; any number read, without locks. Entries are appended
+ * and never moved or reused, so a reader never sees one change under it.
+ * Space given up by removes and replaced values is not reclaimed, and the
+ * number of buckets is fixed when the region is created. */
+
+#include <stddef.h>
+
+typedef struct
+{
+    void *base;
+    size_t size;
+    int writable;
+} hashmap_shm_t;
+
+/**
+ * Create an empty map.
+ * @param fd : file to keep the region in, e.g. from shm_open; -1 for an
+ *             anonymous region shared with children forked later
+ * @param size : bytes in the region, for buckets and entries both
+ * @return the map; NULL on failure */
+hashmap_shm_t *hashmap_shm_create(
+    int fd,
+    size_t size,
+    unsigned int nbuckets
+);
+
+/**
+ * Map a region created by another process, read only.
+ * @return the map; NULL on failure */
+hashmap_shm_t *hashmap_shm_attach(
+    int fd
+);
+
+/**
+ * Unmap the region. The region itself lives on while others map it. */
+void hashmap_shm_detach(
+    hashmap_shm_t * m
+);
+
+/**
+ * @return number of items within the map */
+int hashmap_shm_count(
+    hashmap_shm_t * m
+);
+
+/**
+ * Get this key's value.
+ * @param vlen : set to the value's length, if not NULL
+ * @return the value inside the region; otherwise NULL */
+const void *hashmap_shm_get(
+    hashmap_shm_t * m,
+    const void *key,
+    size_t klen,
+    size_t *vlen
+);
+
+/**
+ * Associate a copy of key with a copy of val.
+ * @return 0 on success; -1 if the region is full or read only */
+int hashmap_shm_put(
+    hashmap_shm_t * m,
+    const void *key,
+    size_t klen,
+    const void *val,
+    size_t vlen
+);
+
+/**
+ * Remove this key and value from the map.
+ * @return 1 if removed, otherwise 0 */
+int hashmap_shm_remove(
+    hashmap_shm_t * m,
+    const void *key,
+    size_t klen
+);
+
+#endif /* HASHMAP_SHM_H */
@@ -0,0 +1,663 @@
+/*
+
+   Copyright (c) 2011, Willem-Hendrik Thiart
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+ * The names of its contributors may not be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+   ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+   WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL WILLEM-HENDRIK THIART BE LIABLE FOR ANY
+   DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+   (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+   LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+   ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "linked_list_hashmap.h"
+#include "hashmap_snapshot.h"
+
+#define SNAPSHOT_MAGIC "LLHM"
+#define DELTA_MAGIC "LLHD"
+#define SNAPSHOT_VERSION 1
+
+/* output buffer for writing snapshots */
+#define WRITE_BUFFER_SIZE (1 << 20)
+
+typedef struct
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t array_size;
+    uint64_t count;
+} header_t;
+
+/* a delta file's header counts buckets, not entries. Each bucket is
+ * followed by its records */
+typedef struct
+{
+    uint64_t bucket;
+    uint64_t count;
+} bucket_t;
+
+/* each record is followed by the encoded key, then the encoded value */
+typedef struct
+{
+    uint64_t hash;
+    uint32_t klen;
+    uint32_t vlen;
+} record_t;
+
+typedef struct
+{
+    hashmap_t *h;
+    const hashmap_codec_t *codec;
+    int fd;
+    char *tmp;
+
+    /* output not yet written */
+    char *out;
+    size_t outlen;
+
+    /* encoded key and value */
+    char *buf;
+    size_t buflen;
+
+    int failed;
+} writer_t;
+
+/**
+ * Allocate everything a save needs, and open the temporary file.
+ * @return 0 on success; -1 on failure */
+static int __writer_init(
+    writer_t * w,
+    hashmap_t * h,
+    const char *path,
+    const hashmap_codec_t * codec
+    )
+{
+    w->tmp = malloc(strlen(path) + sizeof(".tmp"));
+    sprintf(w->tmp, "%s.tmp", path);
+
+    if (-1 == (w->fd = open(w->tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644)))
+    {
+        free(w->tmp);
+        return -1;
+    }
+
+    w->h = h;
+    w->codec = codec;
+    w->out = malloc(WRITE_BUFFER_SIZE);
+    w->outlen = 0;
+    w->buflen = 256;
+    w->buf = malloc(w->buflen);
+    w->failed = 0;
+    return 0;
+}
+
+static void __writer_release(
+    writer_t * w
+    )
+{
+    free(w->out);
+    free(w->buf);
+    free(w->tmp);
+}
+
+static void __flush(
+    writer_t * w
+    )
+{
+    const char *p = w->out;
+
+    while (!w->failed && p < w->out + w->outlen)
+    {
+        ssize_t n = write(w->fd, p, w->out + w->outlen - p);
+
+        if (0 < n)
+            p += n;
+        else if (n < 0 && EINTR != errno)
+            w->failed = 1;
+    }
+
+    w->outlen = 0;
+}
+
+static void __emit(
+    writer_t * w,
+    const void *data,
+    size_t len
+    )
+{
+    while (!w->failed && 0 < len)
+    {
+        size_t n = WRITE_BUFFER_SIZE - w->outlen;
+
+        if (len < n)
+            n = len;
+        memcpy(w->out + w->outlen, data, n);
+        w->outlen += n;
+        data = (const char*)data + n;
+        len -= n;
+
+        if (WRITE_BUFFER_SIZE == w->outlen)
+            __flush(w);
+    }
+}
+
+/**
+ * Encode obj into the writer's buffer, growing the buffer if needed.
+ * @return encoded length */
+static size_t __encode(
+    writer_t * w,
+    hashmap_encode_f encode,
+    const void *obj,
+    size_t offset
+    )
+{
+    size_t len = encode(w->codec->udata, obj, w->buf + offset,
+                        w->buflen - offset);
+
+    if (w->buflen - offset < len)
+    {
+        w->buflen = (offset + len) * 2;
+        w->buf = realloc(w->buf, w->buflen);
+        encode(w->codec->udata, obj, w->buf + offset, w->buflen - offset);
+    }
+
+    return len;
+}
+
+static void __write_entry(void *udata, void *key, void *val)
+{
+    writer_t *w = udata;
+    record_t r;
+
+    if (w->failed)
+        return;
+
+    r.hash = w->h->hash(key);
+    r.klen = __encode(w, w->codec->encode_key, key, 0);
+    r.vlen = __encode(w, w->codec->encode_val, val, r.klen);
+
+    __emit(w, &r, sizeof(r));
+    __emit(w, w->buf, r.klen + r.vlen);
+}
+
+static void __emit_header(
+    writer_t * w,
+    const char *magic,
+    uint64_t count
+    )
+{
+    header_t hd;
+
+    memcpy(hd.magic, magic, sizeof(hd.magic));
+    hd.version = SNAPSHOT_VERSION;
+    hd.array_size = hashmap_size(w->h);
+    hd.count = count;
+    __emit(w, &hd, sizeof(hd));
+}
+
+/**
+ * Make a rename in path's directory durable.
+ * @return 0 on success; -1 on failure */
+static int __sync_dir(
+    const char *path
+    )
+{
+    const char *slash = strrchr(path, '/');
+    char *dir;
+    int fd, ret = -1;
+
+    if (!slash)
+        dir = strdup(".");
+    else if (slash == path)
+        dir = strdup("/");
+    else
+        dir = strndup(path, slash - path);
+
+    if (-1 != (fd = open(dir, O_RDONLY | O_DIRECTORY)))
+    {
+        ret = fsync(fd);
+        close(fd);
+    }
+
+    free(dir);
+    return ret;
+}
+
+/**
+ * Sync and close the file, then rename it into place. The data is on disk
+ * before the rename, and the rename before this returns.
+ * @return 0 on success; -1 on failure, with errno set */
+static int __finish(
+    writer_t * w,
+    const char *path
+    )
+{
+    int err;
+
+    __flush(w);
+
+    if (!w->failed && 0 != fsync(w->fd))
+        w->failed = 1;
+    if (0 != close(w->fd))
+        w->failed = 1;
+    if (!w->failed && 0 != rename(w->tmp, path))
+        w->failed = 1;
+
+    /* the new file is in place; only its durability is in doubt */
+    if (!w->failed && 0 != __sync_dir(path))
+        return -1;
+
+    if (w->failed)
+    {
+        err = errno;
+        unlink(w->tmp);
+        errno = err;
+    }
+
+    return w->failed ? -1 : 0;
+}
+
+/**
+ * Write the snapshot.
+ * @return 0 on success; -1 on failure, with errno set */
+static int __write(
+    writer_t * w,
+    const char *path
+    )
+{
+    __emit_header(w, SNAPSHOT_MAGIC, hashmap_count(w->h));
+
+    /* bucket and chain order, so a load rebuilds the same chains */
+    hashmap_foreach_range(w->h, 0, hashmap_size(w->h), __write_entry, w);
+    return __finish(w, path);
+}
+
+int hashmap_save(
+    hashmap_t * h,
+    const char *path,
+    const hashmap_codec_t * codec
+    )
+{
+    writer_t w;
+    int ret;
+
+    if (0 != __writer_init(&w, h, path, codec))
+        return -1;
+
+    ret = __write(&w, path);
+    __writer_release(&w);
+    return ret;
+}
+
+pid_t hashmap_save_background(
+    hashmap_t * h,
+    const char *path,
+    const hashmap_codec_t * codec
+    )
+{
+    writer_t w;
+    pid_t pid;
+
+    /* open the file before forking, so that a failure is reported here.
+     * The child still allocates and runs the codec, which is why the
+     * process must be single-threaded */
+    if (0 != __writer_init(&w, h, path, codec))
+        return -1;
+
+    if (0 == (pid = fork()))
+        _exit(0 == __write(&w, path) ? 0 : 1);
+
+    if (-1 == pid)
+        unlink(w.tmp);
+    close(w.fd);
+    __writer_release(&w);
+    return pid;
+}
+
+static void __count_entry(
+    void *udata,
+    void *key __attribute__((__unused__)),
+    void *val __attribute__((__unused__))
+    )
+{
+    (*(uint64_t*)udata)++;
+}
+
+int hashmap_save_delta(
+    hashmap_t * h,
+    const char *path,
+    const hashmap_codec_t * codec
+    )
+{
+    writer_t w;
+    uint64_t nbuckets = 0;
+    int b, ret;
+
+    if (!h->dirty)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (0 != __writer_init(&w, h, path, codec))
+        return -1;
+
+    for (b = hashmap_next_dirty(h, 0); 0 <= b; b = hashmap_next_dirty(h, b + 1))
+        nbuckets++;
+    __emit_header(&w, DELTA_MAGIC, nbuckets);
+
+    for (b = hashmap_next_dirty(h, 0); 0 <= b; b = hashmap_next_dirty(h, b + 1))
+    {
+        bucket_t bk;
+
+        /* a bucket that is now empty is written too, to clear it on load */
+        bk.bucket = b;
+        bk.count = 0;
+        hashmap_foreach_range(h, b, b + 1, __count_entry, &bk.count);
+        __emit(&w, &bk, sizeof(bk));
+        hashmap_foreach_range(h, b, b + 1, __write_entry, &w);
+    }
+
+    if (0 == (ret = __finish(&w, path)))
+        hashmap_clear_dirty(h);
+
+    __writer_release(&w);
+    return ret;
+}
+
+int hashmap_save_wait(
+    pid_t pid,
+    int block
+    )
+{
+    int status;
+    pid_t ret;
+
+    while (-1 == (ret = waitpid(pid, &status, block ? 0 : WNOHANG)) &&
+           EINTR == errno)
+        ;
+
+    if (0 == ret)
+        return 1;
+    if (-1 == ret || !WIFEXITED(status) || 0 != WEXITSTATUS(status))
+        return -1;
+    return 0;
+}
+
+/**
+ * Map a snapshot or delta file and read its header.
+ * @return the mapping; NULL on failure */
+static void *__map(
+    const char *path,
+    const char *magic,
+    header_t * hd,
+    size_t *len
+    )
+{
+    struct stat st;
+    void *map = NULL;
+    int fd;
+
+    if (-1 == (fd = open(path, O_RDONLY)))
+        return NULL;
+
+    if (0 != fstat(fd, &st) || (size_t)st.st_size < sizeof(*hd))
+        goto close;
+
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (MAP_FAILED == map)
+    {
+        map = NULL;
+        goto close;
+    }
+    madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+    memcpy(hd, map, sizeof(*hd));
+    if (0 != memcmp(hd->magic, magic, sizeof(hd->magic)) ||
+        SNAPSHOT_VERSION != hd->version || 0 == hd->array_size)
+    {
+        munmap(map, st.st_size);
+        map = NULL;
+    }
+    *len = st.st_size;
+
+close:
+    close(fd);
+    return map;
+}
+
+/**
+ * Step over count records.
+ * @return 0 if they are all there; otherwise -1 */
+static int __records_check(
+    const char **p,
+    const char *end,
+    uint64_t count
+    )
+{
+    for (; 0 < count; count--)
+    {
+        record_t r;
+
+        if ((size_t)(end - *p) < sizeof(r))
+            return -1;
+        memcpy(&r, *p, sizeof(r));
+        *p += sizeof(r);
+
+        if ((size_t)(end - *p) < (size_t)r.klen + r.vlen)
+            return -1;
+        *p += r.klen + r.vlen;
+    }
+
+    return 0;
+}
+
+/**
+ * Decode count records and put them back in their buckets.
+ * @return position after the records */
+static const char *__records_insert(
+    hashmap_t * h,
+    const char *p,
+    uint64_t count,
+    const hashmap_codec_t * codec
+    )
+{
+    for (; 0 < count; count--)
+    {
+        record_t r;
+        void *key, *val;
+
+        memcpy(&r, p, sizeof(r));
+        p += sizeof(r);
+        key = codec->decode_key(codec->udata, p, r.klen);
+        val = codec->decode_val(codec->udata, p + r.klen, r.vlen);
+        p += r.klen + r.vlen;
+
+        hashmap_insert_hashed(h, r.hash, key, val);
+    }
+
+    return p;
+}
+
+hashmap_t *hashmap_load(
+    const char *path,
+    func_longhash_f hash,
+    func_longcmp_f cmp,
+    const hashmap_codec_t * codec
+    )
+{
+    return hashmap_load_reserve(path, hash, cmp, codec, 0);
+}
+
+hashmap_t *hashmap_load_reserve(
+    const char *path,
+    func_longhash_f hash,
+    func_longcmp_f cmp,
+    const hashmap_codec_t * codec,
+    unsigned int extra
+    )
+{
+    header_t hd;
+    hashmap_t *h = NULL;
+    const char *p, *end;
+    uint64_t size;
+    size_t len;
+    void *map;
+
+    if (!(map = __map(path, SNAPSHOT_MAGIC, &hd, &len)))
+        return NULL;
+
+    p = (const char*)map + sizeof(hd);
+    end = (const char*)map + len;
+
+    /* keep the load under the ratio that would make a put grow the map */
+    for (size = hd.array_size; 0 < extra && size <= 2 * (hd.count + extra);)
+        size *= 2;
+
+    /* check the whole file first, so that decoded keys are never leaked */
+    if (0 == __records_check(&p, end, hd.count) && p == end)
+    {
+        h = hashmap_new(hash, cmp, size);
+        __records_insert(h, (const char*)map + sizeof(hd), hd.count, codec);
+    }
+
+    munmap(map, len);
+    return h;
+}
+
+static void __release_entry(
+    void *udata,
+    void *key,
+    void *val
+    )
+{
+    const hashmap_codec_t *codec = ((void**)udata)[0];
+    hashmap_scan_f release = ((void**)udata)[1];
+
+    release(codec->udata, key, val);
+}
+
+/**
+ * Take every entry out of bucket b */
+static void __bucket_empty(
+    hashmap_t * h,
+    int b,
+    const hashmap_codec_t * codec,
+    hashmap_scan_f release
+    )
+{
+    hashmap_iterator_t iter;
+
+    hashmap_iterator_range(h, &iter, b, b + 1);
+    while (hashmap_iterator_has_next(h, &iter))
+    {
+        void *key = hashmap_iterator_next(h, &iter);
+        void *val = hashmap_iterator_remove(h, &iter);
+
+        if (release)
+            release(codec->udata, key, val);
+    }
+}
+
+int hashmap_load_delta(
+    hashmap_t * h,
+    const char *path,
+    const hashmap_codec_t * codec,
+    hashmap_scan_f release
+    )
+{
+    header_t hd;
+    const char *p, *end;
+    size_t len;
+    uint64_t ii;
+    void *map;
+    int ret = -1;
+
+    if (!(map = __map(path, DELTA_MAGIC, &hd, &len)))
+        return -1;
+
+    p = (const char*)map + sizeof(hd);
+    end = (const char*)map + len;
+
+    for (ii = 0; ii < hd.count; ii++)
+    {
+        bucket_t bk;
+
+        if ((size_t)(end - p) < sizeof(bk))
+            goto unmap;
+        memcpy(&bk, p, sizeof(bk));
+        p += sizeof(bk);
+        if (hd.array_size <= bk.bucket || 0 != __records_check(&p, end, bk.count))
+            goto unmap;
+    }
+    if (p != end)
+        goto unmap;
+
+    if (hd.array_size != (uint64_t)hashmap_size(h))
+    {
+        unsigned int factor = hd.array_size / hashmap_size(h);
+
+        /* the map grew after the last checkpoint. Growing marks every
+         * bucket dirty, so the delta has all of them: start again at the
+         * new size */
+        if (hd.count != hd.array_size ||
+            hd.array_size != factor * (uint64_t)hashmap_size(h))
+            goto unmap;
+
+        if (release)
+        {
+            void *ud[2] = { (void*)codec, (void*)release };
+            hashmap_foreach_range(h, 0, hashmap_size(h), __release_entry, ud);
+        }
+        hashmap_clear(h);
+        hashmap_increase_capacity(h, factor);
+    }
+
+    p = (const char*)map + sizeof(hd);
+    for (ii = 0; ii < hd.count; ii++)
+    {
+        bucket_t bk;
+
+        memcpy(&bk, p, sizeof(bk));
+        p += sizeof(bk);
+        __bucket_empty(h, bk.bucket, codec, release);
+        p = __records_insert(h, p, bk.count, codec);
+    }
+    ret = 0;
+
+unmap:
+    if (0 != ret)
+        errno = EINVAL;
+    munmap(map, len);
+    return ret;
+}
+
+/*--------------------------------------------------------------79-characters-*/
@@ -0,0 +1,126 @@
+#ifndef HASHMAP_SNAPSHOT_H
+#define HASHMAP_SNAPSHOT_H
+
+/**
+ * Save a hashmap_t to a file, and load it back without rehashing.
+ *
+ * The file holds the size of the bucket array, then every entry in bucket
+ * and chain order, each with its stored hash. Loading maps the file and
+ * puts every entry straight back into its old bucket: neither the hash nor
+ * the compare function is called.
+ *
+ * A delta holds only the buckets that changed since the last checkpoint
+ * (see hashmap_track_dirty), and is applied to a map loaded from the
+ * snapshot and any earlier deltas.
+ *
+ * Files use the machine's own byte order and word size. */
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#include "linked_list_hashmap.h"
+
+/**
+ * Encode a key or value.
+ * @return bytes needed. Nothing is written if that is more than len */
+typedef size_t (*hashmap_encode_f) (void *udata, const void *obj,
+                                    void *buf, size_t len);
+
+/**
+ * Decode a key or value. buf is only valid during the call.
+ * @return the key or value */
+typedef void *(*hashmap_decode_f) (void *udata, const void *buf, size_t len);
+
+typedef struct
+{
+    hashmap_encode_f encode_key;
+    hashmap_decode_f decode_key;
+    hashmap_encode_f encode_val;
+    hashmap_decode_f decode_val;
+    void *udata;
+} hashmap_codec_t;
+
+/**
+ * Write the map to path. The file is written under a temporary name,
+ * synced, and renamed into place, so path always holds a whole snapshot.
+ * On success, the snapshot survives a crash.
+ * @return 0 on success; -1 on failure, with errno set */
+int hashmap_save(
+    hashmap_t * hmap,
+    const char *path,
+    const hashmap_codec_t * codec
+);
+
+/**
+ * Write the map to path from a forked child, while the caller carries on
+ * changing the map. The child sees the map as it was at the fork, and the
+ * kernel copies only the pages the caller touches meanwhile.
+ * The process must have only one thread: the child allocates memory and
+ * calls the codec, neither of which is safe after forking a threaded
+ * process. Use hashmap_save for maps shared between threads.
+ * @return the child's pid, for hashmap_save_wait; -1 on failure */
+pid_t hashmap_save_background(
+    hashmap_t * hmap,
+    const char *path,
+    const hashmap_codec_t * codec
+);
+
+/**
+ * Reap a child started by hashmap_save_background.
+ * @param block : wait for the child to finish
+ * @return 0 if the snapshot was written; 1 if the child is still running;
+ *         -1 on failure */
+int hashmap_save_wait(
+    pid_t pid,
+    int block
+);
+
+/**
+ * Build a map from a file written by hashmap_save.
+ * @param hash : must be the hash function the map was saved with
+ * @return the map; NULL on failure */
+hashmap_t *hashmap_load(
+    const char *path,
+    func_longhash_f hash,
+    func_longcmp_f cmp,
+    const hashmap_codec_t * codec
+);
+
+/**
+ * As hashmap_load, with room for extra more entries before the map grows.
+ * The bucket array is made bigger up front, and entries are placed by
+ * their stored hashes, so the hash function is still not called.
+ * @return the map; NULL on failure */
+hashmap_t *hashmap_load_reserve(
+    const char *path,
+    func_longhash_f hash,
+    func_longcmp_f cmp,
+    const hashmap_codec_t * codec,
+    unsigned int extra
+);
+
+/**
+ * Write the buckets that changed since the last checkpoint to path, then
+ * mark every bucket clean. The map must be tracking dirty buckets.
+ * After a full hashmap_save, call hashmap_clear_dirty.
+ * @return 0 on success; -1 on failure, with errno set */
+int hashmap_save_delta(
+    hashmap_t * hmap,
+    const char *path,
+    const hashmap_codec_t * codec
+);
+
+/**
+ * Bring a map up to date with a delta written by hashmap_save_delta.
+ * The whole file is checked before the map is touched.
+ * @param release : given the keys and values the delta replaces, with the
+ *                  codec's udata. May be NULL
+ * @return 0 on success; -1 on failure */
+int hashmap_load_delta(
+    hashmap_t * hmap,
+    const char *path,
+    const hashmap_codec_t * codec,
+    hashmap_scan_f release
+);
+
+#endif /* HASHMAP_SNAPSHOT_H */
@@ -0,0 +1,527 @@
+/*
+
+   Copyright (c) 2011, Willem-Hendrik Thiart
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+ * The names of its contributors may not be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+   ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+   WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL WILLEM-HENDRIK THIART BE LIABLE FOR ANY
+   DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+   (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+   LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+   ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <assert.h>
+
+#include "linked_list_hashmap.h"
+#include "hashmap_splitorder.h"
+
+/* when we double the number of buckets */
+#define MAX_LOAD 2
+
+#define LONG_BITS (sizeof(unsigned long) * CHAR_BIT)
+
+/* the low bit of a next pointer marks its node as deleted */
+#define MARKED(p) ((unsigned long)(p) & 1)
+#define MARK(p) ((so_node_t*)((unsigned long)(p) | 1))
+#define UNMARK(p) ((so_node_t*)((unsigned long)(p) & ~1UL))
+
+typedef struct so_node_s so_node_t;
+
+struct so_node_s
+{
+    /* bit-reversed hash; odd for items, even for bucket dummies */
+    unsigned long so_key;
+    void *key;
+    void *val;
+    so_node_t *next;
+    /* link on the retired stack */
+    so_node_t *retired_next;
+};
+
+static const unsigned char __reversed_byte[256] = {
+#define R2(n) n, n + 2 * 64, n + 1 * 64, n + 3 * 64
+#define R4(n) R2(n), R2(n + 2 * 16), R2(n + 1 * 16), R2(n + 3 * 16)
+#define R6(n) R4(n), R4(n + 2 * 4), R4(n + 1 * 4), R4(n + 3 * 4)
+    R6(0), R6(2), R6(1), R6(3)
+#undef R6
+#undef R4
+#undef R2
+};
+
+static unsigned long __reverse(unsigned long v)
+{
+    unsigned long r = 0;
+    unsigned int ii;
+
+    for (ii = 0; ii < sizeof(unsigned long); ii++)
+    {
+        r = (r << CHAR_BIT) | __reversed_byte[v & 0xff];
+        v >>= CHAR_BIT;
+    }
+
+    return r;
+}
+
+static unsigned long __so_regular_key(unsigned long hash)
+{
+    return __reverse(hash) | 1;
+}
+
+static unsigned long __so_dummy_key(unsigned long bucket)
+{
+    return __reverse(bucket);
+}
+
+static so_node_t **__bucket_slot(hashmap_splitorder_t * h, unsigned long b)
+{
+    unsigned int seg;
+    unsigned long idx;
+    so_node_t **segment;
+
+    if (0 == b)
+    {
+        seg = 0;
+        idx = 0;
+    }
+    else
+    {
+        seg = LONG_BITS - __builtin_clzl(b);
+        idx = b - (1UL << (seg - 1));
+    }
+
+    segment = __atomic_load_n(&h->segments[seg], __ATOMIC_ACQUIRE);
+    if (!segment)
+    {
+        so_node_t **expected = NULL;
+        unsigned long len = 0 == seg ? 1 : 1UL << (seg - 1);
+
+        segment = calloc(len, sizeof(so_node_t*));
+        if (!__atomic_compare_exchange_n(&h->segments[seg], &expected,
+                                         segment, 0, __ATOMIC_ACQ_REL,
+                                         __ATOMIC_ACQUIRE))
+        {
+            /* somebody else got there first */
+            free(segment);
+            segment = expected;
+        }
+    }
+
+    return &segment[idx];
+}
+
+static void __retire(hashmap_splitorder_t * h, so_node_t * n)
+{
+    so_node_t *head = __atomic_load_n((so_node_t**)&h->retired,
+                                      __ATOMIC_RELAXED);
+
+    do
+        n->retired_next = head;
+    while (!__atomic_compare_exchange_n((so_node_t**)&h->retired, &head, n,
+                                        1, __ATOMIC_RELEASE,
+                                        __ATOMIC_RELAXED));
+}
+
+/**
+ * Find the node with this split-order key (and key, for items) in the list
+ * hanging off head. Deleted nodes met on the way are unlinked.
+ * @param pprev : set to the link that points, or would point, at the node
+ * @param pcur : set to the node, or the first node past where it would be
+ * @return 1 if found, otherwise 0 */
+static int __find(
+    hashmap_splitorder_t * h,
+    so_node_t * head,
+    unsigned long so_key,
+    const void *key,
+    so_node_t *** pprev,
+    so_node_t ** pcur
+    )
+{
+    so_node_t **prev, *cur, *next;
+
+retry:
+    prev = &head->next;
+    cur = UNMARK(__atomic_load_n(prev, __ATOMIC_ACQUIRE));
+
+    while (cur)
+    {
+        next = __atomic_load_n(&cur->next, __ATOMIC_ACQUIRE);
+
+        if (MARKED(next))
+        {
+            so_node_t *expected = cur;
+
+            /* help unlink the deleted node */
+            if (!__atomic_compare_exchange_n(prev, &expected, UNMARK(next),
+                                             0, __ATOMIC_ACQ_REL,
+                                             __ATOMIC_ACQUIRE))
+                goto retry;
+            __retire(h, cur);
+            cur = UNMARK(next);
+            continue;
+        }
+
+        if (__atomic_load_n(prev, __ATOMIC_ACQUIRE) != cur)
+            goto retry;
+
+        if (so_key < cur->so_key)
+            break;
+
+        /* items with equal hashes share a split-order key */
+        if (so_key == cur->so_key && (!key || 0 == h->compare(key, cur->key)))
+        {
+            *pprev = prev;
+            *pcur = cur;
+            return 1;
+        }
+
+        prev = &cur->next;
+        cur = next;
+    }
+
+    *pprev = prev;
+    *pcur = cur;
+    return 0;
+}
+
+static so_node_t *__get_bucket(hashmap_splitorder_t * h, unsigned long b);
+
+/**
+ * Link a dummy node for this bucket into the list, after its parent's. */
+static so_node_t *__init_bucket(hashmap_splitorder_t * h, unsigned long b)
+{
+    unsigned long parent = b & ~(1UL << (LONG_BITS - 1 - __builtin_clzl(b)));
+    so_node_t *phead = __get_bucket(h, parent), **prev, *cur, *dummy;
+
+    dummy = calloc(1, sizeof(so_node_t));
+    dummy->so_key = __so_dummy_key(b);
+
+    while (1)
+    {
+        if (__find(h, phead, dummy->so_key, NULL, &prev, &cur))
+        {
+            /* another thread initialised the bucket */
+            free(dummy);
+            dummy = cur;
+            break;
+        }
+
+        dummy->next = cur;
+        if (__atomic_compare_exchange_n(prev, &cur, dummy, 0,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+            break;
+    }
+
+    __atomic_store_n(__bucket_slot(h, b), dummy, __ATOMIC_RELEASE);
+    return dummy;
+}
+
+static so_node_t *__get_bucket(hashmap_splitorder_t * h, unsigned long b)
+{
+    so_node_t *head = __atomic_load_n(__bucket_slot(h, b), __ATOMIC_ACQUIRE);
+
+    if (!head)
+        head = __init_bucket(h, b);
+    return head;
+}
+
+static so_node_t *__bucket_for(hashmap_splitorder_t * h, unsigned long hash)
+{
+    unsigned long size = __atomic_load_n(&h->size, __ATOMIC_ACQUIRE);
+    return __get_bucket(h, hash & (size - 1));
+}
+
+hashmap_splitorder_t *hashmap_splitorder_new(
+    func_longhash_f hash,
+    func_longcmp_f cmp,
+    unsigned int initial_capacity
+    )
+{
+    hashmap_splitorder_t *h = calloc(1, sizeof(hashmap_splitorder_t));
+    so_node_t *dummy;
+
+    h->size = 1;
+    while (h->size < initial_capacity)
+        h->size <<= 1;
+    h->segments = calloc(LONG_BITS + 1, sizeof(void*));
+    h->hash = hash;
+    h->compare = cmp;
+
+    /* bucket 0's dummy is the head of the list */
+    dummy = calloc(1, sizeof(so_node_t));
+    *__bucket_slot(h, 0) = dummy;
+    return h;
+}
+
+int hashmap_splitorder_count(hashmap_splitorder_t * h)
+{
+    return __atomic_load_n(&h->count, __ATOMIC_RELAXED);
+}
+
+unsigned long hashmap_splitorder_size(hashmap_splitorder_t * h)
+{
+    return __atomic_load_n(&h->size, __ATOMIC_RELAXED);
+}
+
+void *hashmap_splitorder_get(hashmap_splitorder_t * h, const void *key)
+{
+    so_node_t **prev, *cur;
+    unsigned long hash;
+
+    if (!key)
+        return NULL;
+
+    hash = h->hash(key);
+    if (__find(h, __bucket_for(h, hash), __so_regular_key(hash), key,
+               &prev, &cur))
+        /* NULL if the item is being removed */
+        return __atomic_load_n(&cur->val, __ATOMIC_ACQUIRE);
+    return NULL;
+}
+
+int hashmap_splitorder_contains_key(hashmap_splitorder_t * h, const void *key)
+{
+    return NULL != hashmap_splitorder_get(h, key);
+}
+
+static void __ensurecapacity(hashmap_splitorder_t * h)
+{
+    unsigned long size = __atomic_load_n(&h->size, __ATOMIC_RELAXED);
+
+    /* new buckets are initialised lazily, so doubling is just this */
+    if (size * MAX_LOAD < (unsigned long)__atomic_load_n(&h->count,
+                                                         __ATOMIC_RELAXED)
+        && size < 1UL << (LONG_BITS - 2))
+        __atomic_compare_exchange_n(&h->size, &size, size * 2, 0,
+                                    __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+}
+
+/**
+ * Mark this node's next pointer so that __find unlinks it. */
+static void __mark(so_node_t * n)
+{
+    so_node_t *next = __atomic_load_n(&n->next, __ATOMIC_ACQUIRE);
+
+    while (!MARKED(next))
+        if (__atomic_compare_exchange_n(&n->next, &next, MARK(next), 0,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            break;
+}
+
+/**
+ * An item is removed the moment its value is swapped for NULL. Marking and
+ * unlinking the node afterwards is only clean up.
+ * @return 1 if we removed it; 0 if the value was no longer expected */
+static int __remove_node(
+    hashmap_splitorder_t * h,
+    so_node_t * head,
+    so_node_t * n,
+    void *expected
+    )
+{
+    so_node_t **prev, *cur;
+
+    if (!expected ||
+        !__atomic_compare_exchange_n(&n->val, &expected, NULL, 0,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        return 0;
+
+    __atomic_sub_fetch(&h->count, 1, __ATOMIC_RELAXED);
+    __mark(n);
+    __find(h, head, n->so_key, n->key, &prev, &cur);
+    return 1;
+}
+
+/**
+ * @param replace : overwrite the value of an existing equal key
+ * @return previous associated val; otherwise NULL */
+static void *__put(
+    hashmap_splitorder_t * h,
+    void *key,
+    void *val,
+    int replace
+    )
+{
+    so_node_t **prev, *cur, *node;
+    unsigned long hash, so_key;
+
+    if (!key || !val)
+        return NULL;
+
+    hash = h->hash(key);
+    so_key = __so_regular_key(hash);
+    node = NULL;
+
+    while (1)
+    {
+        so_node_t *head = __bucket_for(h, hash);
+
+        if (__find(h, head, so_key, key, &prev, &cur))
+        {
+            void *val_prev = __atomic_load_n(&cur->val, __ATOMIC_ACQUIRE);
+
+            if (!val_prev)
+            {
+                /* being removed; get it out of the way and insert */
+                __mark(cur);
+                continue;
+            }
+
+            if (replace &&
+                !__atomic_compare_exchange_n(&cur->val, &val_prev, val, 0,
+                                             __ATOMIC_ACQ_REL,
+                                             __ATOMIC_ACQUIRE))
+                continue;
+
+            free(node);
+            return val_prev;
+        }
+
+        if (!node)
+        {
+            node = calloc(1, sizeof(so_node_t));
+            node->so_key = so_key;
+            node->key = key;
+            node->val = val;
+        }
+
+        node->next = cur;
+        if (__atomic_compare_exchange_n(prev, &cur, node, 0,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+            break;
+    }
+
+    __atomic_add_fetch(&h->count, 1, __ATOMIC_RELAXED);
+    __ensurecapacity(h);
+    return NULL;
+}
+
+void *hashmap_splitorder_put(hashmap_splitorder_t * h, void *key, void *val)
+{
+    return __put(h, key, val, 1);
+}
+
+void *hashmap_splitorder_put_if_absent(
+    hashmap_splitorder_t * h,
+    void *key,
+    void *val
+    )
+{
+    return __put(h, key, val, 0);
+}
+
+int hashmap_splitorder_replace_if(
+    hashmap_splitorder_t * h,
+    const void *key,
+    const void *expected,
+    void *val_new
+    )
+{
+    so_node_t **prev, *cur;
+    unsigned long hash;
+    void *val = (void*)expected;
+
+    if (!key || !expected || !val_new)
+        return 0;
+
+    hash = h->hash(key);
+    if (!__find(h, __bucket_for(h, hash), __so_regular_key(hash), key,
+                &prev, &cur))
+        return 0;
+
+    return __atomic_compare_exchange_n(&cur->val, &val, val_new, 0,
+                                       __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+int hashmap_splitorder_remove_if(
+    hashmap_splitorder_t * h,
+    const void *key,
+    const void *expected
+    )
+{
+    so_node_t **prev, *cur, *head;
+    unsigned long hash;
+
+    if (!key)
+        return 0;
+
+    hash = h->hash(key);
+    head = __bucket_for(h, hash);
+    if (!__find(h, head, __so_regular_key(hash), key, &prev, &cur))
+        return 0;
+
+    return __remove_node(h, head, cur, (void*)expected);
+}
+
+void *hashmap_splitorder_remove(hashmap_splitorder_t * h, const void *key)
+{
+    so_node_t **prev, *cur, *head;
+    unsigned long hash;
+
+    if (!key)
+        return NULL;
+
+    hash = h->hash(key);
+    head = __bucket_for(h, hash);
+    if (!__find(h, head, __so_regular_key(hash), key, &prev, &cur))
+        return NULL;
+
+    while (1)
+    {
+        void *val = __atomic_load_n(&cur->val, __ATOMIC_ACQUIRE);
+
+        /* NULL means somebody else is removing it */
+        if (!val)
+            return NULL;
+
+        if (__remove_node(h, head, cur, val))
+            return val;
+    }
+}
+
+void hashmap_splitorder_freeall(hashmap_splitorder_t * h)
+{
+    so_node_t *n;
+    unsigned int ii;
+
+    /* the list includes every dummy and every live or marked item */
+    for (n = *__bucket_slot(h, 0); n; )
+    {
+        so_node_t *next = UNMARK(n->next);
+        free(n);
+        n = next;
+    }
+
+    for (n = h->retired; n; )
+    {
+        so_node_t *next = n->retired_next;
+        free(n);
+        n = next;
+    }
+
+    for (ii = 0; ii <= LONG_BITS; ii++)
+        free(h->segments[ii]);
+    free(h->segments);
+    free(h);
+}
+
+/*--------------------------------------------------------------79-characters-*/
@@ -0,0 +1,119 @@
+#ifndef HASHMAP_SPLITORDER_H
+#define HASHMAP_SPLITORDER_H
+
+/**
+ * A lock-free hashmap built on split-ordered lists (Shalev and Shavit).
+ *
+ * All items live in one lock-free linked list, sorted by their bit-reversed
+ * hash. The bucket table only holds shortcuts into that list, through dummy
+ * nodes that are created the first time a bucket is used. Doubling the
+ * number of buckets never moves a node.
+ *
+ * Every update is a single CAS on an item's value word; an item is removed
+ * when its value is swapped for NULL, then marked and unlinked.
+ *
+ * Removed nodes are unlinked but not freed until the map is freed, because
+ * another thread may still be traversing them. */
+
+#include "linked_list_hashmap.h"
+
+typedef struct
+{
+    /* number of buckets; always a power of two */
+    unsigned long size;
+    long count;
+    /* segments of the bucket table; segment i holds 2^(i-1) buckets */
+    void **segments;
+    /* unlinked nodes waiting for the map to be freed */
+    void *retired;
+    func_longhash_f hash;
+    func_longcmp_f compare;
+} hashmap_splitorder_t;
+
+hashmap_splitorder_t *hashmap_splitorder_new(
+    func_longhash_f hash,
+    func_longcmp_f cmp,
+    unsigned int initial_capacity
+);
+
+/**
+ * @return number of items within hash */
+int hashmap_splitorder_count(
+    hashmap_splitorder_t * h
+);
+
+/**
+ * @return number of buckets */
+unsigned long hashmap_splitorder_size(
+    hashmap_splitorder_t * h
+);
+
+/**
+ * Get this key's value.
+ * @return key's item, otherwise NULL */
+void *hashmap_splitorder_get(
+    hashmap_splitorder_t * h,
+    const void *key
+);
+
+/**
+ * Is this key inside this map?
+ * @return 1 if key is in hash, otherwise 0 */
+int hashmap_splitorder_contains_key(
+    hashmap_splitorder_t * h,
+    const void *key
+);
+
+/**
+ * Associate key with val.
+ * @return previous associated val; otherwise NULL */
+void *hashmap_splitorder_put(
+    hashmap_splitorder_t * h,
+    void *key,
+    void *val
+);
+
+/**
+ * Remove this key and value from the map.
+ * @return value of key, or NULL on failure */
+void *hashmap_splitorder_remove(
+    hashmap_splitorder_t * h,
+    const void *key
+);
+
+/**
+ * Associate key with val, unless an equal key exists.
+ * @return val already associated with key; otherwise NULL */
+void *hashmap_splitorder_put_if_absent(
+    hashmap_splitorder_t * h,
+    void *key,
+    void *val
+);
+
+/**
+ * Associate key with val_new, if key is currently associated with expected.
+ * @return 1 if replaced, otherwise 0 */
+int hashmap_splitorder_replace_if(
+    hashmap_splitorder_t * h,
+    const void *key,
+    const void *expected,
+    void *val_new
+);
+
+/**
+ * Remove key, if it is currently associated with expected.
+ * @return 1 if removed, otherwise 0 */
+int hashmap_splitorder_remove_if(
+    hashmap_splitorder_t * h,
+    const void *key,
+    const void *expected
+);
+
+/**
+ * Free all the memory related to this hash.
+ * No other thread may be using the map. */
+void hashmap_splitorder_freeall(
+    hashmap_splitorder_t * h
+);
+
+#endif /* HASHMAP_SPLITORDER_H */
@@ -0,0 +1,308 @@
+/*
+
+   Copyright (c) 2011, Willem-Hendrik Thiart
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+ * The names of its contributors may not be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+   ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+   WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL WILLEM-HENDRIK THIART BE LIABLE FOR ANY
+   DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+   (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+   LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+   ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "linked_list_hashmap.h"
+#include "hashmap_unrolled.h"
+
+/* what fits in a cache line beside the fingerprints and the next link */
+#define ENTRIES_PER_BLOCK 3
+
+/* when we call for more capacity; items per bucket */
+#define MAX_LOAD 2.0
+
+typedef struct block_s block_t;
+
+/* entries are packed at the front; only the first `used` are valid */
+struct block_s
+{
+    unsigned char fps[ENTRIES_PER_BLOCK];
+    unsigned char used;
+    hashmap_entry_t entries[ENTRIES_PER_BLOCK];
+    block_t *next;
+} __attribute__((aligned(64)));
+
+/**
+ * Spread the hash (splitmix64's finaliser). The low bits pick the bucket
+ * and the top byte is the fingerprint */
+static unsigned long __mix(
+    unsigned long x
+    )
+{
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9UL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebUL;
+    return x ^ (x >> 31);
+}
+
+static unsigned char __fingerprint(
+    unsigned long mixed
+    )
+{
+    return mixed >> (sizeof(unsigned long) * 8 - 8);
+}
+
+static block_t *__bucket(
+    hashmap_unrolled_t * h,
+    unsigned long mixed
+    )
+{
+    return &((block_t*)h->buckets)[mixed & (h->nbuckets - 1)];
+}
+
+static block_t *__alloc_blocks(
+    unsigned int n
+    )
+{
+    void *b;
+
+    if (posix_memalign(&b, 64, n * sizeof(block_t)))
+        return NULL;
+    memset(b, 0, n * sizeof(block_t));
+    return b;
+}
+
+/**
+ * @return block holding key, with its index in *idx; otherwise NULL */
+static block_t *__find(
+    hashmap_unrolled_t * h,
+    unsigned long mixed,
+    const void *key,
+    int *idx
+    )
+{
+    unsigned char fp = __fingerprint(mixed);
+    block_t *b;
+    int ii;
+
+    for (b = __bucket(h, mixed); b; b = b->next)
+        for (ii = 0; ii < b->used; ii++)
+            if (b->fps[ii] == fp && 0 == h->compare(key, b->entries[ii].key))
+            {
+                *idx = ii;
+                return b;
+            }
+
+    return NULL;
+}
+
+/**
+ * Add an entry that isn't in the map to the end of its chain */
+static void __append(
+    hashmap_unrolled_t * h,
+    unsigned long mixed,
+    void *key,
+    void *val
+    )
+{
+    block_t *b = __bucket(h, mixed);
+
+    while (b->next)
+        b = b->next;
+
+    if (ENTRIES_PER_BLOCK == b->used)
+    {
+        b->next = __alloc_blocks(1);
+        b = b->next;
+    }
+
+    b->fps[b->used] = __fingerprint(mixed);
+    b->entries[b->used].key = key;
+    b->entries[b->used].val = val;
+    b->used++;
+}
+
+static void __blocks_free(
+    block_t * b
+    )
+{
+    while (b)
+    {
+        block_t *next = b->next;
+        free(b);
+        b = next;
+    }
+}
+
+static void __grow(
+    hashmap_unrolled_t * h
+    )
+{
+    block_t *old = h->buckets;
+    unsigned int ii, nold = h->nbuckets;
+
+    h->nbuckets *= 2;
+    h->buckets = __alloc_blocks(h->nbuckets);
+
+    for (ii = 0; ii < nold; ii++)
+    {
+        block_t *b;
+        int jj;
+
+        for (b = &old[ii]; b; b = b->next)
+            for (jj = 0; jj < b->used; jj++)
+                __append(h, __mix(h->hash(b->entries[jj].key)),
+                         b->entries[jj].key, b->entries[jj].val);
+
+        __blocks_free(old[ii].next);
+    }
+
+    free(old);
+}
+
+hashmap_unrolled_t *hashmap_unrolled_new(
+    func_longhash_f hash,
+    func_longcmp_f cmp,
+    unsigned int initial_capacity
+    )
+{
+    hashmap_unrolled_t *h = calloc(1, sizeof(hashmap_unrolled_t));
+
+    for (h->nbuckets = 1; h->nbuckets * MAX_LOAD < initial_capacity;
+         h->nbuckets *= 2)
+        ;
+    h->buckets = __alloc_blocks(h->nbuckets);
+    h->hash = hash;
+    h->compare = cmp;
+    return h;
+}
+
+int hashmap_unrolled_count(
+    hashmap_unrolled_t * h
+    )
+{
+    return h->count;
+}
+
+int hashmap_unrolled_size(
+    hashmap_unrolled_t * h
+    )
+{
+    return h->nbuckets;
+}
+
+void *hashmap_unrolled_get(
+    hashmap_unrolled_t * h,
+    const void *key
+    )
+{
+    block_t *b;
+    int idx;
+
+    if (0 == h->count || !key ||
+        !(b = __find(h, __mix(h->hash(key)), key, &idx)))
+        return NULL;
+    return b->entries[idx].val;
+}
+
+int hashmap_unrolled_contains_key(
+    hashmap_unrolled_t * h,
+    const void *key
+    )
+{
+    return NULL != hashmap_unrolled_get(h, key);
+}
+
+void *hashmap_unrolled_put(
+    hashmap_unrolled_t * h,
+    void *key,
+    void *val
+    )
+{
+    unsigned long mixed;
+    block_t *b;
+    int idx;
+
+    if (!key || !val)
+        return NULL;
+
+    mixed = __mix(h->hash(key));
+    if ((b = __find(h, mixed, key, &idx)))
+    {
+        void *val_prev = b->entries[idx].val;
+        b->entries[idx].val = val;
+        return val_prev;
+    }
+
+    if (h->nbuckets * MAX_LOAD <= h->count)
+        __grow(h);
+
+    __append(h, mixed, key, val);
+    h->count++;
+    return NULL;
+}
+
+void *hashmap_unrolled_remove(
+    hashmap_unrolled_t * h,
+    const void *key
+    )
+{
+    unsigned long mixed;
+    block_t *b, *last, *prev = NULL;
+    void *val;
+    int idx;
+
+    if (!key || !(b = __find(h, mixed = __mix(h->hash(key)), key, &idx)))
+        return NULL;
+
+    val = b->entries[idx].val;
+
+    /* fill the hole with the chain's last entry, keeping blocks packed */
+    for (last = __bucket(h, mixed); last->next; last = last->next)
+        prev = last;
+    last->used--;
+    b->fps[idx] = last->fps[last->used];
+    b->entries[idx] = last->entries[last->used];
+
+    /* the first block lives in the bucket array */
+    if (0 == last->used && prev)
+    {
+        prev->next = NULL;
+        free(last);
+    }
+
+    h->count--;
+    return val;
+}
+
+void hashmap_unrolled_freeall(
+    hashmap_unrolled_t * h
+    )
+{
+    unsigned int ii;
+
+    for (ii = 0; ii < h->nbuckets; ii++)
+        __blocks_free(((block_t*)h->buckets)[ii].next);
+    free(h->buckets);
+    free(h);
+}
+
+/*--------------------------------------------------------------79-characters-*/
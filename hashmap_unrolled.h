@@ -0,0 +1,82 @@
+#ifndef HASHMAP_UNROLLED_H
+#define HASHMAP_UNROLLED_H
+
+/**
+ * A chained hashmap whose chains are unrolled: each link is one 64-byte
+ * cache line holding several entries, plus a one-byte fingerprint of each
+ * entry's hash. The first link of every chain sits in the bucket array.
+ *
+ * A lookup reads a line at a time, and only calls the compare function
+ * when a fingerprint matches. Collisions fill the slots of existing links
+ * before a new link is allocated. */
+
+#include "linked_list_hashmap.h"
+
+typedef struct
+{
+    int count;
+    /* number of buckets; always a power of two */
+    unsigned int nbuckets;
+    void *buckets;
+    func_longhash_f hash;
+    func_longcmp_f compare;
+} hashmap_unrolled_t;
+
+hashmap_unrolled_t *hashmap_unrolled_new(
+    func_longhash_f hash,
+    func_longcmp_f cmp,
+    unsigned int initial_capacity
+);
+
+/**
+ * @return number of items within hash */
+int hashmap_unrolled_count(
+    hashmap_unrolled_t * h
+);
+
+/**
+ * @return number of buckets */
+int hashmap_unrolled_size(
+    hashmap_unrolled_t * h
+);
+
+/**
+ * Get this key's value.
+ * @return key's item, otherwise NULL */
+void *hashmap_unrolled_get(
+    hashmap_unrolled_t * h,
+    const void *key
+);
+
+/**
+ * Is this key inside this map?
+ * @return 1 if key is in hash, otherwise 0 */
+int hashmap_unrolled_contains_key(
+    hashmap_unrolled_t * h,
+    const void *key
+);
+
+/**
+ * Associate key with val.
+ * @return previous associated val; otherwise NULL */
+void *hashmap_unrolled_put(
+    hashmap_unrolled_t * h,
+    void *key,
+    void *val
+);
+
+/**
+ * Remove this key and value from the map.
+ * @return value of key, or NULL on failure */
+void *hashmap_unrolled_remove(
+    hashmap_unrolled_t * h,
+    const void *key
+);
+
+/**
+ * Free all the memory related to this hash. */
+void hashmap_unrolled_freeall(
+    hashmap_unrolled_t * h
+);
+
+#endif /* HASHMAP_UNROLLED_H */
@@ -0,0 +1,472 @@
+/*
+
+   Copyright (c) 2011, Willem-Hendrik Thiart
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+ * The names of its contributors may not be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+   ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+   WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL WILLEM-HENDRIK THIART BE LIABLE FOR ANY
+   DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+   (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+   LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+   ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "linked_list_hashmap.h"
+#include "hashmap_snapshot.h"
+#include "hashmap_wal.h"
+
+/* each record is followed by the encoded key, then the encoded value */
+typedef struct
+{
+    /* covers everything after this field, including key and value */
+    uint32_t sum;
+    uint32_t op;
+    uint64_t hash;
+    uint32_t klen;
+    uint32_t vlen;
+} record_t;
+
+/**
+ * FNV-1a */
+static uint32_t __checksum(
+    uint32_t sum,
+    const void *data,
+    size_t len
+    )
+{
+    const unsigned char *p = data;
+
+    while (len--)
+        sum = (sum ^ *p++) * 16777619u;
+    return sum;
+}
+
+static uint32_t __record_checksum(
+    const record_t * r,
+    const void *payload
+    )
+{
+    uint32_t sum = 2166136261u;
+
+    sum = __checksum(sum, (const char*)r + sizeof(r->sum),
+                     sizeof(*r) - sizeof(r->sum));
+    return __checksum(sum, payload, (size_t)r->klen + r->vlen);
+}
+
+static void __reserve(
+    hashmap_wal_t * w,
+    size_t len
+    )
+{
+    if (w->size - w->len < len)
+    {
+        w->size = (w->len + len) * 2;
+        w->buf = realloc(w->buf, w->size);
+    }
+}
+
+size_t hashmap_wal_encode(
+    const hashmap_codec_t * codec,
+    int op,
+    unsigned long hash,
+    const void *key,
+    const void *val,
+    void *buf,
+    size_t len
+    )
+{
+    char *p = buf;
+    size_t room = len < sizeof(record_t) ? 0 : len - sizeof(record_t);
+    record_t r;
+
+    r.op = op;
+    r.hash = hash;
+    r.klen = key ? codec->encode_key(codec->udata, key, p + len - room, room)
+        : 0;
+    room = room < r.klen ? 0 : room - r.klen;
+    r.vlen = val ? codec->encode_val(codec->udata, val, p + len - room, room)
+        : 0;
+
+    if (sizeof(r) + r.klen + r.vlen <= len)
+    {
+        r.sum = __record_checksum(&r, p + sizeof(r));
+        memcpy(p, &r, sizeof(r));
+    }
+
+    return sizeof(r) + r.klen + r.vlen;
+}
+
+static void __release(
+    hashmap_scan_f release,
+    const hashmap_codec_t * codec,
+    void *key,
+    void *val
+    )
+{
+    if (release && (key || val))
+        release(codec->udata, key, val);
+}
+
+static void __release_entry(
+    void *udata,
+    void *key,
+    void *val
+    )
+{
+    void **ud = udata;
+
+    __release(ud[1], ud[0], key, val);
+}
+
+long hashmap_wal_apply(
+    hashmap_t * h,
+    const void *buf,
+    size_t len,
+    const hashmap_codec_t * codec,
+    hashmap_scan_f release
+    )
+{
+    const char *p = buf;
+    hashmap_entry_t ety;
+    record_t r;
+    void *key;
+
+    if (len < sizeof(r))
+        return 0;
+
+    memcpy(&r, p, sizeof(r));
+    if (len - sizeof(r) < (size_t)r.klen + r.vlen)
+        return 0;
+    if (r.sum != __record_checksum(&r, p + sizeof(r)))
+        return -1;
+
+    switch (r.op)
+    {
+    case HASHMAP_OP_PUT:
+    case HASHMAP_OP_REMOVE:
+        key = codec->decode_key(codec->udata, p + sizeof(r), r.klen);
+        hashmap_remove_entry_hashed(h, &ety, r.hash, key);
+        __release(release, codec, ety.key, ety.val);
+
+        if (HASHMAP_OP_PUT == r.op)
+            hashmap_put_hashed(h, r.hash, key,
+                               codec->decode_val(codec->udata,
+                                                 p + sizeof(r) + r.klen,
+                                                 r.vlen));
+        else
+            __release(release, codec, key, NULL);
+        break;
+
+    case HASHMAP_OP_CLEAR:
+        if (release)
+        {
+            void *ud[2] = { (void*)codec, (void*)release };
+            hashmap_foreach_range(h, 0, hashmap_size(h), __release_entry, ud);
+        }
+        hashmap_clear(h);
+        break;
+
+    default:
+        return -1;
+    }
+
+    return sizeof(r) + r.klen + r.vlen;
+}
+
+/**
+ * Write out the buffered records, keeping whatever could not be written.
+ * @return 0 on success; -1 on failure */
+static int __write_buf(
+    hashmap_wal_t * w
+    )
+{
+    size_t done = 0;
+    int ret = 0;
+
+    while (done < w->len)
+    {
+        ssize_t n = write(w->fd, w->buf + done, w->len - done);
+
+        if (n < 0)
+        {
+            if (EINTR == errno)
+                continue;
+            ret = -1;
+            break;
+        }
+        done += n;
+    }
+
+    memmove(w->buf, w->buf + done, w->len - done);
+    w->len -= done;
+    return ret;
+}
+
+/**
+ * Write and fsync the buffered records. A failure stays recorded until a
+ * caller sees it through hashmap_wal_sync */
+static void __sync(
+    hashmap_wal_t * w
+    )
+{
+    if (0 != __write_buf(w) || 0 != fdatasync(w->fd))
+        w->failed = 1;
+    else
+        w->pending = 0;
+}
+
+static void __append(
+    hashmap_wal_t * w,
+    int op,
+    unsigned long hash,
+    const void *key,
+    const void *val
+    )
+{
+    size_t n = hashmap_wal_encode(w->codec, op, hash, key, val,
+                                  w->buf + w->len, w->size - w->len);
+
+    if (w->size - w->len < n)
+    {
+        __reserve(w, n);
+        hashmap_wal_encode(w->codec, op, hash, key, val,
+                           w->buf + w->len, w->size - w->len);
+    }
+    w->len += n;
+
+    /* after a failure, records wait for an explicit sync */
+    if (w->group <= ++w->pending && !w->failed)
+        __sync(w);
+}
+
+/**
+ * Apply the records in the log to the map.
+ * @return length of the intact part of the log */
+static size_t __replay(
+    hashmap_t * h,
+    const char *log,
+    size_t len,
+    const hashmap_codec_t * codec,
+    hashmap_scan_f release
+    )
+{
+    size_t at = 0;
+    long n;
+
+    while (0 < (n = hashmap_wal_apply(h, log + at, len - at, codec, release)))
+        at += n;
+
+    return at;
+}
+
+/**
+ * @return upper bound on how many entries replaying the log adds */
+static unsigned int __count_puts(
+    const char *log,
+    size_t len
+    )
+{
+    const char *p = log, *end = log + len;
+    unsigned int n = 0;
+
+    while (sizeof(record_t) <= (size_t)(end - p))
+    {
+        record_t r;
+
+        memcpy(&r, p, sizeof(r));
+        if ((size_t)(end - p) - sizeof(r) < (size_t)r.klen + r.vlen)
+            break;
+        n += HASHMAP_OP_PUT == r.op;
+        p += sizeof(r) + r.klen + r.vlen;
+    }
+
+    return n;
+}
+
+/**
+ * Load the snapshot, sized so that replaying the log never resizes it */
+static hashmap_t *__load(
+    const char *snapshot_path,
+    func_longhash_f hash,
+    func_longcmp_f cmp,
+    const hashmap_codec_t * codec,
+    unsigned int puts
+    )
+{
+    if (!snapshot_path || 0 != access(snapshot_path, F_OK))
+        return hashmap_new(hash, cmp, 11 < puts * 2 + 1 ? puts * 2 + 1 : 11);
+
+    return hashmap_load_reserve(snapshot_path, hash, cmp, codec, puts);
+}
+
+hashmap_wal_t *hashmap_wal_open(
+    const char *path,
+    const char *snapshot_path,
+    func_longhash_f hash,
+    func_longcmp_f cmp,
+    const hashmap_codec_t * codec,
+    hashmap_scan_f release,
+    unsigned int group
+    )
+{
+    hashmap_wal_t *w;
+    struct stat st;
+    hashmap_t *h;
+    size_t intact = 0;
+    char *log = NULL;
+    int fd;
+
+    if (-1 == (fd = open(path, O_RDWR | O_CREAT | O_APPEND, 0644)))
+        return NULL;
+
+    if (0 != fstat(fd, &st))
+        goto fail;
+
+    if (0 < st.st_size)
+    {
+        log = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (MAP_FAILED == log)
+            goto fail;
+        madvise(log, st.st_size, MADV_SEQUENTIAL);
+    }
+
+    h = __load(snapshot_path, hash, cmp, codec,
+               log ? __count_puts(log, st.st_size) : 0);
+    if (!h)
+        goto unmap;
+
+    if (log)
+    {
+        intact = __replay(h, log, st.st_size, codec, release);
+        munmap(log, st.st_size);
+    }
+
+    /* drop a torn tail, so new records follow the last intact one */
+    if (intact < (size_t)st.st_size && 0 != ftruncate(fd, intact))
+    {
+        hashmap_freeall(h);
+        goto fail;
+    }
+
+    w = calloc(1, sizeof(hashmap_wal_t));
+    w->map = h;
+    w->codec = codec;
+    w->fd = fd;
+    w->group = group;
+    return w;
+
+unmap:
+    if (log)
+        munmap(log, st.st_size);
+fail:
+    close(fd);
+    return NULL;
+}
+
+void *hashmap_wal_put(
+    hashmap_wal_t * w,
+    void *key,
+    void *val
+    )
+{
+    unsigned long hash;
+
+    if (!key || !val)
+        return NULL;
+
+    hash = w->map->hash(key);
+    __append(w, HASHMAP_OP_PUT, hash, key, val);
+    return hashmap_put_hashed(w->map, hash, key, val);
+}
+
+void *hashmap_wal_remove(
+    hashmap_wal_t * w,
+    const void *key
+    )
+{
+    hashmap_entry_t ety;
+    unsigned long hash;
+
+    if (!key)
+        return NULL;
+
+    hash = w->map->hash(key);
+    hashmap_remove_entry_hashed(w->map, &ety, hash, key);
+
+    /* nothing to log if nothing changed */
+    if (ety.key)
+        __append(w, HASHMAP_OP_REMOVE, hash, key, NULL);
+    return ety.val;
+}
+
+int hashmap_wal_sync(
+    hashmap_wal_t * w
+    )
+{
+    int failed = w->failed;
+
+    w->failed = 0;
+    if (0 < w->pending)
+        __sync(w);
+
+    failed |= w->failed;
+    w->failed = 0;
+    return failed ? -1 : 0;
+}
+
+int hashmap_wal_checkpoint(
+    hashmap_wal_t * w,
+    const char *snapshot_path
+    )
+{
+    if (0 != hashmap_wal_sync(w))
+        return -1;
+
+    /* a crash before the log is emptied replays it over the snapshot,
+     * which leaves the map as it is */
+    if (0 != hashmap_save(w->map, snapshot_path, w->codec) ||
+        0 != ftruncate(w->fd, 0) ||
+        0 != fdatasync(w->fd))
+        return -1;
+
+    return 0;
+}
+
+int hashmap_wal_close(
+    hashmap_wal_t * w
+    )
+{
+    int ret = hashmap_wal_sync(w);
+
+    close(w->fd);
+    free(w->buf);
+    free(w);
+    return ret;
+}
+
+/*--------------------------------------------------------------79-characters-*/
@@ -0,0 +1,128 @@
+#ifndef HASHMAP_WAL_H
+#define HASHMAP_WAL_H
+
+/**
+ * A write-ahead log of puts and removes, for using a hashmap_t as a durable
+ * local store.
+ *
+ * Each record holds the key's hash, so recovery places entries without
+ * calling the hash function. Records are buffered and written with one
+ * fsync per group, trading the last few puts on a crash for put latency.
+ * A checkpoint writes a snapshot (see hashmap_snapshot.h) and empties the
+ * log; recovery loads the snapshot and replays the log written since.
+ *
+ * Every record carries a checksum. Recovery stops at the first torn or
+ * damaged record and cuts the log there. */
+
+#include "linked_list_hashmap.h"
+#include "hashmap_snapshot.h"
+
+typedef struct
+{
+    /* the map being logged. Read it directly; change it only through
+     * hashmap_wal_put and hashmap_wal_remove */
+    hashmap_t *map;
+    const hashmap_codec_t *codec;
+    int fd;
+
+    /* records not yet written */
+    char *buf;
+    size_t len;
+    size_t size;
+
+    unsigned int group;
+    unsigned int pending;
+
+    /* a write or sync has failed since the last hashmap_wal_sync. The
+     * records not yet written stay in buf */
+    int failed;
+} hashmap_wal_t;
+
+/**
+ * Recover a map and keep logging its changes to path.
+ * @param snapshot_path : snapshot to start from; may be NULL or not exist
+ * @param release : given keys and values that recovery drops, with the
+ *                  codec's udata; either may be NULL. release may be NULL
+ * @param group : records per fsync; 0 or 1 syncs every record
+ * @return the log; NULL on failure */
+hashmap_wal_t *hashmap_wal_open(
+    const char *path,
+    const char *snapshot_path,
+    func_longhash_f hash,
+    func_longcmp_f cmp,
+    const hashmap_codec_t * codec,
+    hashmap_scan_f release,
+    unsigned int group
+);
+
+/**
+ * Log, then associate key with val.
+ * @return previous associated val; otherwise NULL */
+void *hashmap_wal_put(
+    hashmap_wal_t * w,
+    void *key,
+    void *val
+);
+
+/**
+ * Log, then remove this key and value from the map.
+ * @return value of key, or NULL on failure */
+void *hashmap_wal_remove(
+    hashmap_wal_t * w,
+    const void *key
+);
+
+/**
+ * Write and fsync every record logged so far.
+ * @return 0 on success; -1 if this or any earlier write failed */
+int hashmap_wal_sync(
+    hashmap_wal_t * w
+);
+
+/**
+ * Save a snapshot of the map to snapshot_path, then empty the log.
+ * @return 0 on success; -1 on failure */
+int hashmap_wal_checkpoint(
+    hashmap_wal_t * w,
+    const char *snapshot_path
+);
+
+/**
+ * Sync and close the log. The map is left to the caller.
+ * @return result of the final sync */
+int hashmap_wal_close(
+    hashmap_wal_t * w
+);
+
+/**
+ * Encode one log record. Other transports (see hashmap_cdc.h) use the same
+ * format.
+ * @param op : HASHMAP_OP_PUT, HASHMAP_OP_REMOVE or HASHMAP_OP_CLEAR
+ * @param key : NULL for HASHMAP_OP_CLEAR
+ * @param val : NULL unless op is HASHMAP_OP_PUT
+ * @return bytes needed. Nothing is written if that is more than len */
+size_t hashmap_wal_encode(
+    const hashmap_codec_t * codec,
+    int op,
+    unsigned long hash,
+    const void *key,
+    const void *val,
+    void *buf,
+    size_t len
+);
+
+/**
+ * Apply the log record at the start of buf to the map.
+ * @param release : given the keys and values the record replaces, with the
+ *                  codec's udata. May be NULL
+ * @return bytes used; 0 if buf holds less than a whole record; -1 if the
+ *         record is damaged */
+long hashmap_wal_apply(
+    hashmap_t * hmap,
+    const void *buf,
+    size_t len,
+    const hashmap_codec_t * codec,
+    hashmap_scan_f release
+);
+
+#endif /* HASHMAP_WAL_H */
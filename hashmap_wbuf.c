@@ -0,0 +1,122 @@
+/*
+
+   Copyright (c) 2011, Willem-Hendrik Thiart
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+ * The names of its contributors may not be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+   ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+   WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL WILLEM-HENDRIK THIART BE LIABLE FOR ANY
+   DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+   (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+   LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+   ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "linked_list_hashmap.h"
+#include "hashmap_seqlock.h"
+#include "hashmap_wbuf.h"
+
+hashmap_wbuf_t *hashmap_wbuf_new(
+    hashmap_seqlock_t * shared,
+    unsigned int threshold,
+    hashmap_merge_f merge,
+    void *udata
+    )
+{
+    hashmap_wbuf_t *b;
+
+    assert(0 < threshold);
+
+    b = calloc(1, sizeof(hashmap_wbuf_t));
+    b->shared = shared;
+    /* sized so the buffer never grows before it is flushed */
+    b->local = hashmap_new(shared->hash, shared->compare, threshold * 2 + 1);
+    b->threshold = threshold;
+    b->batch = malloc(threshold * sizeof(hashmap_entry_t));
+    b->merge = merge;
+    b->udata = udata;
+    return b;
+}
+
+int hashmap_wbuf_count(hashmap_wbuf_t * b)
+{
+    return hashmap_count(b->local);
+}
+
+void *hashmap_wbuf_get(hashmap_wbuf_t * b, const void *key)
+{
+    void *val = hashmap_get(b->local, key), *shared;
+
+    if (val && !b->merge)
+        return val;
+
+    shared = hashmap_seqlock_get(b->shared, key);
+    if (!val)
+        return shared;
+    if (!shared)
+        return val;
+    return b->merge(b->udata, shared, val);
+}
+
+void hashmap_wbuf_put(hashmap_wbuf_t * b, void *key, void *val)
+{
+    void *prev;
+
+    if (!key || !val)
+        return;
+
+    if (!b->merge)
+        hashmap_put(b->local, key, val);
+    else if ((prev = hashmap_put_if_absent(b->local, key, val)))
+        hashmap_put(b->local, key, b->merge(b->udata, prev, val));
+
+    if (b->threshold <= hashmap_count(b->local))
+        hashmap_wbuf_flush(b);
+}
+
+int hashmap_wbuf_flush(hashmap_wbuf_t * b)
+{
+    hashmap_iterator_t iter;
+    void *key;
+    int n = 0;
+
+    hashmap_iterator(b->local, &iter);
+    while ((key = hashmap_iterator_next(b->local, &iter)))
+    {
+        b->batch[n].key = key;
+        b->batch[n].val = hashmap_get(b->local, key);
+        n++;
+    }
+
+    hashmap_seqlock_put_batch(b->shared, b->batch, n, b->merge, b->udata);
+    hashmap_clear(b->local);
+    return n;
+}
+
+void hashmap_wbuf_freeall(hashmap_wbuf_t * b)
+{
+    hashmap_wbuf_flush(b);
+    hashmap_freeall(b->local);
+    free(b->batch);
+    free(b);
+}
+
+/*--------------------------------------------------------------79-characters-*/
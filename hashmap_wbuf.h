@@ -0,0 +1,76 @@
+#ifndef HASHMAP_WBUF_H
+#define HASHMAP_WBUF_H
+
+/**
+ * A per-thread write buffer in front of a shared hashmap_seqlock_t.
+ *
+ * Puts land in a small private hashmap_t and reach the shared map in
+ * batches, either once the buffer holds threshold items or when flushed.
+ * A batch takes each stripe lock of the shared map once, rather than once
+ * per put. Reads look in the buffer first.
+ *
+ * A write buffer belongs to one thread. Many buffers may share a map. */
+
+#include "linked_list_hashmap.h"
+#include "hashmap_seqlock.h"
+
+typedef struct
+{
+    hashmap_seqlock_t *shared;
+    hashmap_t *local;
+    int threshold;
+    /* scratch space for handing a batch to the shared map */
+    hashmap_entry_t *batch;
+    hashmap_merge_f merge;
+    void *udata;
+} hashmap_wbuf_t;
+
+/**
+ * @param threshold : flush once this many items are buffered
+ * @param merge : if not NULL, values for the same key are combined with
+ *                merge(udata, older, newer) instead of overwritten, both in
+ *                the buffer and in the shared map. Suits counters. */
+hashmap_wbuf_t *hashmap_wbuf_new(
+    hashmap_seqlock_t * shared,
+    unsigned int threshold,
+    hashmap_merge_f merge,
+    void *udata
+);
+
+/**
+ * @return number of items waiting to be flushed */
+int hashmap_wbuf_count(
+    hashmap_wbuf_t * b
+);
+
+/**
+ * Get this key's value, as seen by this thread.
+ * With a merge function, a buffered value is merged onto the shared one.
+ * @return key's item, otherwise NULL */
+void *hashmap_wbuf_get(
+    hashmap_wbuf_t * b,
+    const void *key
+);
+
+/**
+ * Buffer key and val for the shared map. */
+void hashmap_wbuf_put(
+    hashmap_wbuf_t * b,
+    void *key,
+    void *val
+);
+
+/**
+ * Move everything buffered into the shared map.
+ * @return number of items flushed */
+int hashmap_wbuf_flush(
+    hashmap_wbuf_t * b
+);
+
+/**
+ * Flush, then free the buffer. The shared map is left alone. */
+void hashmap_wbuf_freeall(
+    hashmap_wbuf_t * b
+);
+
+#endif /* HASHMAP_WBUF_H */
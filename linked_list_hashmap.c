@@ -38,6 +38,14 @@
 /* when we call for more capacity */
 #define SPACERATIO 0.5
 
+/* how many buckets ahead batched iteration prefetches */
+#define PREFETCH_DISTANCE 8
+
+/* chain nodes are carved out of blocks of this many nodes */
+#define NODES_PER_BLOCK 64
+
+#define BITS_PER_WORD (sizeof(unsigned long) * 8)
+
 typedef struct node_s node_t;
 
 struct node_s
@@ -46,20 +54,139 @@ struct node_s
     node_t *next;
 };
 
+typedef struct node_block_s node_block_t;
+
+struct node_block_s
+{
+    node_block_t *next;
+    node_t nodes[];
+};
+
 static void __ensurecapacity(
     hashmap_t * h
     );
 
 /**
- * Allocate memory for nodes. Used for chained nodes. */
+ * Allocate memory for nodes. Used for the bucket array. */
 static node_t *__allocnodes(
     unsigned int count
     )
 {
-    // FIXME: make a chain node reservoir
     return calloc(count, sizeof(node_t));
 }
 
+/**
+ * Allocate a dirty bitmap for this many buckets.
+ * @param set : start with every bucket dirty */
+static unsigned long *__dirty_alloc(
+    unsigned int nbuckets,
+    int set
+    )
+{
+    size_t words = (nbuckets + BITS_PER_WORD - 1) / BITS_PER_WORD;
+    unsigned long *d = calloc(words, sizeof(unsigned long));
+
+    if (set)
+        memset(d, 0xff, words * sizeof(unsigned long));
+    return d;
+}
+
+/**
+ * Record a change to key: mark its bucket dirty and call the mutation
+ * hook */
+static void __changed(
+    hashmap_t * h,
+    int op,
+    unsigned long hash,
+    void *key,
+    void *val
+    )
+{
+    if (h->dirty)
+    {
+        unsigned long b = hash % h->arraySize;
+        h->dirty[b / BITS_PER_WORD] |= 1UL << (b % BITS_PER_WORD);
+    }
+
+    if (h->on_mutation)
+        h->on_mutation(h->mutation_udata, op, hash, key, val);
+}
+
+/**
+ * Only hashes the key if someone is listening */
+static void __changed_key(
+    hashmap_t * h,
+    int op,
+    void *key,
+    void *val
+    )
+{
+    if (h->dirty || h->on_mutation)
+        __changed(h, op, h->hash(key), key, val);
+}
+
+/**
+ * Every entry is gone */
+static void __changed_all(
+    hashmap_t * h
+    )
+{
+    if (h->dirty)
+    {
+        free(h->dirty);
+        h->dirty = __dirty_alloc(h->arraySize, 1);
+    }
+
+    if (h->on_mutation)
+        h->on_mutation(h->mutation_udata, HASHMAP_OP_CLEAR, 0, NULL, NULL);
+}
+
+/**
+ * Take a chain node from the map's reservoir.
+ * Chain nodes are only returned to the allocator when the map is freed or
+ * drained. This keeps their memory type-stable, so a reader holding a stale
+ * pointer never follows freed memory (see hashmap_seqlock.c). hashmap_drain
+ * frees them on a live map, so it must not be used with concurrent readers.
+ * A recycled node keeps its old key until it is reassigned. */
+static node_t *__node_alloc(
+    hashmap_t * h
+    )
+{
+    node_t *n;
+
+    if (!h->free_nodes)
+    {
+        node_block_t *b;
+        int ii;
+
+        b = calloc(1, sizeof(node_block_t) + NODES_PER_BLOCK * sizeof(node_t));
+        b->next = h->node_blocks;
+        h->node_blocks = b;
+
+        for (ii = NODES_PER_BLOCK - 1; 0 <= ii; ii--)
+        {
+            b->nodes[ii].next = h->free_nodes;
+            h->free_nodes = &b->nodes[ii];
+        }
+    }
+
+    n = h->free_nodes;
+    h->free_nodes = n->next;
+    n->next = NULL;
+    return n;
+}
+
+/**
+ * Give a chain node back to the map's reservoir. */
+static void __node_release(
+    hashmap_t * h,
+    node_t * n
+    )
+{
+    n->next = h->free_nodes;
+    h->free_nodes = n;
+}
+
 hashmap_t *hashmap_new(
     func_longhash_f hash,
     func_longcmp_f cmp,
@@ -93,7 +220,7 @@ static void __node_empty(hashmap_t * h, node_t * node)
     if (node)
     {
         __node_empty(h, node->next);
-        free(node);
+        __node_release(h, node);
         h->count--;
     }
 }
@@ -120,14 +247,154 @@ void hashmap_clear(hashmap_t * h)
         assert(0 <= h->count);
     }
 
+    __changed_all(h);
     assert(0 == hashmap_count(h));
 }
 
+/**
+ * Give every chain node back to the allocator in one go, without
+ * walking any chains. */
+static void __node_blocks_free(hashmap_t * h)
+{
+    node_block_t *b;
+
+    for (b = h->node_blocks; b; )
+    {
+        node_block_t *next = b->next;
+        free(b);
+        b = next;
+    }
+    h->node_blocks = NULL;
+    h->free_nodes = NULL;
+}
+
 void hashmap_free(hashmap_t * h)
 {
     assert(h);
+    h->on_mutation = NULL;
     hashmap_clear(h);
     free(h->array);
+    free(h->dirty);
+    __node_blocks_free(h);
+}
+
+int hashmap_drain(hashmap_t * h, hashmap_entry_t * out)
+{
+    int ii, count = 0;
+
+    for (ii = 0; ii < h->arraySize; ii++)
+    {
+        node_t *n = &((node_t*)h->array)[ii];
+
+        if (!n->ety.key)
+            continue;
+
+        for (; n; n = n->next)
+            out[count++] = n->ety;
+    }
+
+    assert(count == h->count);
+
+    memset(h->array, 0, h->arraySize * sizeof(node_t));
+    __node_blocks_free(h);
+    __changed_all(h);
+    h->count = 0;
+    return count;
+}
+
+hashmap_t *hashmap_clone(hashmap_t * h)
+{
+    hashmap_t *c;
+    node_block_t *b = NULL;
+    int ii, nchained = h->count, k = 0;
+
+    c = malloc(sizeof(hashmap_t));
+    *c = *h;
+    c->array = malloc(h->arraySize * sizeof(node_t));
+    memcpy(c->array, h->array, h->arraySize * sizeof(node_t));
+    c->free_nodes = NULL;
+    c->node_blocks = NULL;
+    c->dirty = NULL;
+    c->on_mutation = NULL;
+
+    /* everything that isn't on the array is on a chain */
+    for (ii = 0; ii < h->arraySize; ii++)
+        if (((node_t*)h->array)[ii].ety.key)
+            nchained--;
+
+    if (0 < nchained)
+    {
+        b = malloc(sizeof(node_block_t) + nchained * sizeof(node_t));
+        b->next = NULL;
+        c->node_blocks = b;
+    }
+
+    /* copy the chains into the one block, in order */
+    for (ii = 0; ii < h->arraySize; ii++)
+    {
+        node_t *n, *prev = &((node_t*)c->array)[ii];
+
+        if (!prev->ety.key)
+            continue;
+
+        for (n = prev->next; n; n = n->next)
+        {
+            node_t *m = &b->nodes[k++];
+
+            m->ety = n->ety;
+            m->next = NULL;
+            prev->next = m;
+            prev = m;
+        }
+    }
+
+    assert(k == nchained);
+    return c;
+}
+
+/**
+ * Move the table of one map into another. Dirty tracking and the
+ * mutation hook belong to the map, not the table, so they stay put */
+static void __take_contents(hashmap_t * to, const hashmap_t * from)
+{
+    to->count = from->count;
+    to->arraySize = from->arraySize;
+    to->array = from->array;
+    to->hash = from->hash;
+    to->compare = from->compare;
+    to->free_nodes = from->free_nodes;
+    to->node_blocks = from->node_blocks;
+}
+
+/**
+ * Every entry was replaced: report a clear, then each entry as put */
+static void __changed_contents(hashmap_t * h)
+{
+    int ii;
+
+    __changed_all(h);
+
+    if (!h->on_mutation)
+        return;
+
+    for (ii = 0; ii < h->arraySize; ii++)
+    {
+        node_t *n;
+
+        for (n = &((node_t*)h->array)[ii]; n && n->ety.key; n = n->next)
+            h->on_mutation(h->mutation_udata, HASHMAP_OP_PUT,
+                           h->hash(n->ety.key), n->ety.key, n->ety.val);
+    }
+}
+
+void hashmap_swap(hashmap_t * a, hashmap_t * b)
+{
+    hashmap_t tmp = *a;
+
+    __take_contents(a, b);
+    __take_contents(b, &tmp);
+    __changed_contents(a);
+    __changed_contents(b);
 }
 
 void hashmap_freeall(hashmap_t * h)
@@ -159,8 +426,13 @@ void *hashmap_get(
     {
         /* iterate down the node's linked list chain */
         do
-            if (0 == h->compare(key, node->ety.key))
+        {
+            /* read the key once; a concurrent writer may be changing it */
+            void *k = node->ety.key;
+
+            if (k && 0 == h->compare(key, k))
                 return (void*)node->ety.val;
+        }
         while ((node = node->next));
     }
 
@@ -175,65 +447,111 @@ int hashmap_contains_key(
     return NULL != hashmap_get(h, key);
 }
 
-void hashmap_remove_entry(
+/**
+ * Find the node holding this key.
+ * @param n_parent : set to the node before it on the chain, or NULL if the
+ *                   node is on the array
+ * @return node holding key; otherwise NULL */
+static node_t *__find_hashed(
     hashmap_t * h,
-    hashmap_entry_t * entry,
-    const void *key
+    unsigned long hash,
+    const void *key,
+    node_t ** n_parent
     )
 {
-    node_t *n, *n_parent;
+    node_t *n = &((node_t*)h->array)[hash % h->arraySize];
 
-    n = &((node_t*)h->array)[__do_probe(h, key)];
+    *n_parent = NULL;
 
     if (!n->ety.key)
-        goto notfound;
-
-    n_parent = NULL;
+        return NULL;
 
     do
     {
-        if (0 != h->compare(key, n->ety.key))
-        {
-            /* does not match, traverse the chain.. */
-            n_parent = n;
-            n = n->next;
-            continue;
-        }
+        if (0 == h->compare(key, n->ety.key))
+            return n;
 
-        memcpy(entry, &n->ety, sizeof(hashmap_entry_t));
+        /* does not match, traverse the chain.. */
+        *n_parent = n;
+    }
+    while ((n = n->next));
 
-        /* I am not a chain node */
-        if (!n_parent)
-        {
-            /* I have a node on my chain. This node will replace me */
-            if (n->next)
-            {
-                node_t *tmp = n->next;
-                memcpy(&n->ety, &tmp->ety, sizeof(hashmap_entry_t));
-                /* Replace me with my next on chain */
-                n->next = tmp->next;
-                free(tmp);
-            }
-            else
-                /* un-assign */
-                n->ety.key = NULL;
-        }
-        else
+    return NULL;
+}
+
+static node_t *__find(
+    hashmap_t * h,
+    const void *key,
+    node_t ** n_parent
+    )
+{
+    return __find_hashed(h, h->hash(key), key, n_parent);
+}
+
+/**
+ * Take this node's entry out of the map. */
+static void __node_unlink(
+    hashmap_t * h,
+    node_t * n,
+    node_t * n_parent
+    )
+{
+    hashmap_entry_t ety = n->ety;
+
+    /* I am not a chain node */
+    if (!n_parent)
+    {
+        /* I have a node on my chain. This node will replace me */
+        if (n->next)
         {
+            node_t *tmp = n->next;
+            memcpy(&n->ety, &tmp->ety, sizeof(hashmap_entry_t));
             /* Replace me with my next on chain */
-            n_parent->next = n->next;
-            free(n);
+            n->next = tmp->next;
+            __node_release(h, tmp);
         }
+        else
+            /* un-assign */
+            n->ety.key = NULL;
+    }
+    else
+    {
+        /* Replace me with my next on chain */
+        n_parent->next = n->next;
+        __node_release(h, n);
+    }
 
-        h->count--;
-        return;
+    h->count--;
+    __changed_key(h, HASHMAP_OP_REMOVE, ety.key, ety.val);
+}
+
+void hashmap_remove_entry(
+    hashmap_t * h,
+    hashmap_entry_t * entry,
+    const void *key
+    )
+{
+    hashmap_remove_entry_hashed(h, entry, h->hash(key), key);
+}
 
+void hashmap_remove_entry_hashed(
+    hashmap_t * h,
+    hashmap_entry_t * entry,
+    unsigned long hash,
+    const void *key
+    )
+{
+    node_t *n, *n_parent;
+
+    if (!(n = __find_hashed(h, hash, key, &n_parent)))
+    {
+        entry->key = NULL;
+        entry->val = NULL;
+        return;
     }
-    while (n);
 
-notfound:
-    entry->key = NULL;
-    entry->val = NULL;
+    memcpy(entry, &n->ety, sizeof(hashmap_entry_t));
+    __node_unlink(h, n, n_parent);
 }
 
 void *hashmap_remove(hashmap_t * h, const void *key)
@@ -243,6 +561,35 @@ void *hashmap_remove(hashmap_t * h, const void *key)
     return (void*)entry.val;
 }
 
+int hashmap_remove_if(hashmap_t * h, const void *key, const void *expected)
+{
+    node_t *n, *n_parent;
+
+    if (!key || !(n = __find(h, key, &n_parent)) || n->ety.val != expected)
+        return 0;
+
+    __node_unlink(h, n, n_parent);
+    return 1;
+}
+
+int hashmap_replace_if(
+    hashmap_t * h,
+    const void *key,
+    const void *expected,
+    void *val_new
+    )
+{
+    node_t *n, *n_parent;
+
+    if (!key || !val_new || !(n = __find(h, key, &n_parent)) ||
+        n->ety.val != expected)
+        return 0;
+
+    n->ety.val = val_new;
+    __changed_key(h, HASHMAP_OP_PUT, n->ety.key, val_new);
+    return 1;
+}
+
 inline static void __nodeassign(
     hashmap_t * h,
     node_t * node,
@@ -259,7 +606,16 @@ inline static void __nodeassign(
     node->ety.val = val;
 }
 
-void *hashmap_put(hashmap_t * h, void *key, void *val_new)
+/**
+ * @param replace : overwrite the value of an existing equal key
+ * @return previous associated val; otherwise NULL */
+static void *__put(
+    hashmap_t * h,
+    unsigned long hash,
+    void *key,
+    void *val_new,
+    int replace
+    )
 {
     if (!key || !val_new)
         return NULL;
@@ -270,13 +626,16 @@ void *hashmap_put(hashmap_t * h, void *key, void *val_new)
 
     __ensurecapacity(h);
 
-    node_t *node = &((node_t*)h->array)[__do_probe(h, key)];
+    node_t *node = &((node_t*)h->array)[hash % h->arraySize];
 
     assert(node);
 
     /* this one wasn't assigned */
     if (NULL == node->ety.key)
+    {
         __nodeassign(h, node, key, val_new);
+        __changed(h, HASHMAP_OP_PUT, hash, key, val_new);
+    }
     else
     {
         /* check the linked list */
@@ -286,28 +645,220 @@ void *hashmap_put(hashmap_t * h, void *key, void *val_new)
             if (0 == h->compare(key, node->ety.key))
             {
                 void *val_prev = node->ety.val;
-                node->ety.val = val_new;
+                if (replace)
+                {
+                    node->ety.val = val_new;
+                    __changed(h, HASHMAP_OP_PUT, hash, node->ety.key, val_new);
+                }
                 return val_prev;
             }
         }
         while (node->next && (node = node->next));
 
-        node->next = __allocnodes(1);
-        __nodeassign(h, node->next, key, val_new);
+        /* fill the node in before linking it, so it is never seen half
+         * assigned. Recycled nodes still hold a key, so count here */
+        node_t *n = __node_alloc(h);
+        n->ety.key = key;
+        n->ety.val = val_new;
+        h->count++;
+        node->next = n;
+        __changed(h, HASHMAP_OP_PUT, hash, key, val_new);
     }
 
     return NULL;
 }
 
+void *hashmap_put(hashmap_t * h, void *key, void *val_new)
+{
+    if (!key)
+        return NULL;
+    return __put(h, h->hash(key), key, val_new, 1);
+}
+
+void *hashmap_put_hashed(
+    hashmap_t * h,
+    unsigned long hash,
+    void *key,
+    void *val_new
+    )
+{
+    return __put(h, hash, key, val_new, 1);
+}
+
+void *hashmap_put_if_absent(hashmap_t * h, void *key, void *val)
+{
+    if (!key)
+        return NULL;
+    return __put(h, h->hash(key), key, val, 0);
+}
+
+void hashmap_insert_hashed(
+    hashmap_t * h,
+    unsigned long hash,
+    void *key,
+    void *val
+    )
+{
+    node_t *node = &((node_t*)h->array)[hash % h->arraySize];
+
+    assert(key);
+    assert(val);
+
+    __changed(h, HASHMAP_OP_PUT, hash, key, val);
+
+    if (NULL == node->ety.key)
+    {
+        __nodeassign(h, node, key, val);
+        return;
+    }
+
+    /* append, so that chains come back in the order they were saved */
+    while (node->next)
+        node = node->next;
+
+    node_t *n = __node_alloc(h);
+    n->ety.key = key;
+    n->ety.val = val;
+    h->count++;
+    node->next = n;
+}
+
+void hashmap_track_dirty(hashmap_t * h, int on)
+{
+    free(h->dirty);
+    h->dirty = on ? __dirty_alloc(h->arraySize, 0) : NULL;
+}
+
+void hashmap_clear_dirty(hashmap_t * h)
+{
+    if (h->dirty)
+        memset(h->dirty, 0, (h->arraySize + BITS_PER_WORD - 1) /
+               BITS_PER_WORD * sizeof(unsigned long));
+}
+
+int hashmap_next_dirty(hashmap_t * h, int from)
+{
+    unsigned int w, nwords;
+    unsigned long bits;
+
+    if (!h->dirty || from < 0 || h->arraySize <= from)
+        return -1;
+
+    nwords = (h->arraySize + BITS_PER_WORD - 1) / BITS_PER_WORD;
+    w = from / BITS_PER_WORD;
+    bits = h->dirty[w] & (~0UL << (from % BITS_PER_WORD));
+
+    /* skip clean words whole */
+    while (!bits)
+    {
+        if (++w == nwords)
+            return -1;
+        bits = h->dirty[w];
+    }
+
+    from = w * BITS_PER_WORD + __builtin_ctzl(bits);
+    return from < h->arraySize ? from : -1;
+}
+
+void hashmap_set_mutation_hook(
+    hashmap_t * h,
+    hashmap_mutation_f fn,
+    void *udata
+    )
+{
+    h->on_mutation = fn;
+    h->mutation_udata = udata;
+}
+
 void hashmap_put_entry(hashmap_t * h, hashmap_entry_t * entry)
 {
     hashmap_put(h, entry->key, entry->val);
 }
 
+hashmap_frozen_t *hashmap_freeze(hashmap_t * h)
+{
+    hashmap_frozen_t *f;
+    int ii, k = 0;
+
+    /* one allocation: the struct, then the offsets, then the entries */
+    f = malloc(sizeof(hashmap_frozen_t) +
+               (h->arraySize + 1) * sizeof(unsigned int) +
+               h->count * sizeof(hashmap_entry_t) + sizeof(void*));
+    f->count = h->count;
+    f->nbuckets = h->arraySize;
+    f->offsets = (unsigned int*)(f + 1);
+    f->entries = (hashmap_entry_t*)
+        (((unsigned long)(f->offsets + h->arraySize + 1) + sizeof(void*) - 1) &
+         ~(sizeof(void*) - 1));
+    f->hash = h->hash;
+    f->compare = h->compare;
+
+    /* chains are already grouped by bucket */
+    for (ii = 0; ii < h->arraySize; ii++)
+    {
+        node_t *n = &((node_t*)h->array)[ii];
+
+        f->offsets[ii] = k;
+        if (!n->ety.key)
+            continue;
+
+        for (; n; n = n->next)
+            f->entries[k++] = n->ety;
+    }
+    f->offsets[ii] = k;
+
+    assert(k == f->count);
+
+    /* the chains go back in one go, without being walked again */
+    h->on_mutation = NULL;
+    free(h->array);
+    free(h->dirty);
+    __node_blocks_free(h);
+    free(h);
+    return f;
+}
+
+int hashmap_frozen_count(const hashmap_frozen_t * f)
+{
+    return f->count;
+}
+
+void *hashmap_frozen_get(const hashmap_frozen_t * f, const void *key)
+{
+    unsigned int ii, b;
+
+    if (0 == f->count || !key)
+        return NULL;
+
+    b = f->hash(key) % f->nbuckets;
+    for (ii = f->offsets[b]; ii < f->offsets[b + 1]; ii++)
+        if (0 == f->compare(key, f->entries[ii].key))
+            return f->entries[ii].val;
+
+    return NULL;
+}
+
+int hashmap_frozen_contains_key(const hashmap_frozen_t * f, const void *key)
+{
+    return NULL != hashmap_frozen_get(f, key);
+}
+
+void hashmap_frozen_free(hashmap_frozen_t * f)
+{
+    free(f);
+}
+
 void hashmap_increase_capacity(hashmap_t * h, unsigned int factor)
 {
     node_t *array_old;
     int ii, asize_old;
+    unsigned long *dirty = h->dirty;
+    hashmap_mutation_f on_mutation = h->on_mutation;
+
+    /* every bucket moves; mark them all once we are done. Nothing changes
+     * as far as the mutation hook is concerned */
+    h->dirty = NULL;
+    h->on_mutation = NULL;
 
     /*  stored old array */
     array_old = h->array;
@@ -336,12 +887,19 @@ void hashmap_increase_capacity(hashmap_t * h, unsigned int factor)
             node_t *next = node->next;
             hashmap_put(h, node->ety.key, node->ety.val);
             assert(NULL != node->ety.key);
-            free(node);
+            __node_release(h, node);
             node = next;
         }
     }
 
     free(array_old);
+    h->on_mutation = on_mutation;
+
+    if (dirty)
+    {
+        free(dirty);
+        h->dirty = __dirty_alloc(h->arraySize, 1);
+    }
 }
 
 static void __ensurecapacity(hashmap_t * h)
@@ -352,6 +910,15 @@ static void __ensurecapacity(hashmap_t * h)
         hashmap_increase_capacity(h, 2);
 }
 
+/**
+ * @return the bucket this iterator stops before */
+static int __iterator_end(hashmap_t * h, hashmap_iterator_t * iter)
+{
+    if (iter->end < 0 || h->arraySize < iter->end)
+        return h->arraySize;
+    return iter->end;
+}
+
 void* hashmap_iterator_peek(
     hashmap_t * h,
     hashmap_iterator_t * iter
@@ -359,7 +926,9 @@ void* hashmap_iterator_peek(
 {
     if (NULL == iter->cur_linked)
     {
-        for (; iter->cur < h->arraySize; iter->cur++)
+        int end = __iterator_end(h, iter);
+
+        for (; iter->cur < end; iter->cur++)
         {
             node_t *node = &((node_t*)h->array)[iter->cur];
 
@@ -405,6 +974,8 @@ void *hashmap_iterator_next(hashmap_t * h, hashmap_iterator_t * iter)
     {
         node_t *n_parent = &((node_t*)h->array)[iter->cur];
 
+        iter->prev_cur = iter->cur;
+
         /* check that we aren't following a dangling pointer.
          * There is a chance that cur_linked is now on the array. */
         if (!n_parent->next)
@@ -420,12 +991,15 @@ void *hashmap_iterator_next(hashmap_t * h, hashmap_iterator_t * iter)
                 iter->cur++;
             iter->cur_linked = n->next;
         }
+        iter->prev = n;
         return n->ety.key;
     }
     /*  otherwise check if we have a node to look at */
     else
     {
-        for (; iter->cur < h->arraySize; iter->cur++)
+        int end = __iterator_end(h, iter);
+
+        for (; iter->cur < end; iter->cur++)
         {
             n = &((node_t*)h->array)[iter->cur];
 
@@ -434,10 +1008,15 @@ void *hashmap_iterator_next(hashmap_t * h, hashmap_iterator_t * iter)
         }
 
         /*  exit if we are at the end */
-        if (h->arraySize == iter->cur)
+        if (end <= iter->cur)
+        {
+            iter->prev = NULL;
             return NULL;
+        }
 
         n = &((node_t*)h->array)[iter->cur];
+        iter->prev = n;
+        iter->prev_cur = iter->cur;
 
         if (n->next)
             iter->cur_linked = n->next;
@@ -452,6 +1031,194 @@ void *hashmap_iterator_next(hashmap_t * h, hashmap_iterator_t * iter)
     }
 }
 
+void hashmap_foreach_range(
+    hashmap_t * h,
+    int from,
+    int to,
+    hashmap_scan_f fn,
+    void *udata
+    )
+{
+    int ii;
+
+    if (h->arraySize < to)
+        to = h->arraySize;
+
+    for (ii = from; ii < to; ii++)
+    {
+        node_t *n = &((node_t*)h->array)[ii];
+
+        if (!n->ety.key)
+            continue;
+
+        for (; n; n = n->next)
+            fn(udata, n->ety.key, n->ety.val);
+    }
+}
+
+static unsigned long __reverse_bits(unsigned long v)
+{
+    unsigned long r = 0;
+    unsigned int ii;
+
+    for (ii = 0; ii < sizeof(unsigned long) * 8; ii++, v >>= 1)
+        r = (r << 1) | (v & 1);
+    return r;
+}
+
+unsigned long hashmap_scan(
+    hashmap_t * h,
+    unsigned long cursor,
+    hashmap_scan_f fn,
+    void *udata
+    )
+{
+    unsigned long odd, mask, r, v;
+    node_t *n;
+
+    /* The array size is odd * 2^k. Puts only ever double the capacity, and
+     * callers may only grow it by powers of two mid-scan, so hash % odd
+     * never changes. Bucket r + odd * v is visited for every r in
+     * order, with v counting up over its k bits in reverse, most significant
+     * bit first. When the array doubles, each visited bucket splits into two
+     * buckets that also count as visited, so no key present for the whole
+     * scan is missed. */
+    for (odd = h->arraySize; !(odd & 1); odd >>= 1)
+        ;
+    mask = h->arraySize / odd - 1;
+    r = cursor % odd;
+    v = (cursor / odd) & mask;
+
+    for (n = &((node_t*)h->array)[r + odd * v]; n && n->ety.key; n = n->next)
+        fn(udata, n->ety.key, n->ety.val);
+
+    v |= ~mask;
+    v = __reverse_bits(v);
+    v++;
+    v = __reverse_bits(v);
+
+    /* the reversed count wrapped around; move on to the next residue */
+    if (0 == (v & mask))
+    {
+        if (++r == odd)
+            return 0;
+        v = 0;
+    }
+
+    return r + odd * (v & mask);
+}
+
+int hashmap_iterator_next_batch(
+    hashmap_t * h,
+    hashmap_iterator_t * iter,
+    hashmap_entry_t * out,
+    int max
+    )
+{
+    node_t *array = h->array, *n = iter->cur_linked;
+    int end = __iterator_end(h, iter), count = 0;
+
+    while (count < max)
+    {
+        if (!n)
+        {
+            for (; iter->cur < end; iter->cur++)
+            {
+                if (iter->cur + PREFETCH_DISTANCE < end)
+                    __builtin_prefetch(&array[iter->cur + PREFETCH_DISTANCE]);
+
+                if (array[iter->cur].ety.key)
+                    break;
+            }
+
+            if (end <= iter->cur)
+                break;
+
+            n = &array[iter->cur];
+        }
+
+        if (n->next)
+            __builtin_prefetch(n->next);
+
+        out[count].key = n->ety.key;
+        out[count].val = n->ety.val;
+        count++;
+
+        /* same convention as hashmap_iterator_next: only move past the
+         * bucket once its chain is done */
+        if (!(n = n->next))
+            iter->cur++;
+    }
+
+    iter->cur_linked = n;
+    iter->prev = NULL;
+    return count;
+}
+
+void *hashmap_iterator_remove(hashmap_t * h, hashmap_iterator_t * iter)
+{
+    node_t *n = iter->prev, *head, *n_parent = NULL;
+    void *val;
+
+    if (!n)
+        return NULL;
+
+    /* find the parent by address; no need to hash or compare */
+    head = &((node_t*)h->array)[iter->prev_cur];
+    if (n != head)
+    {
+        for (n_parent = head; n_parent->next != n; n_parent = n_parent->next)
+            ;
+    }
+    /* the next node on the chain is about to be moved onto the array.
+     * The iterator was going to follow the chain to it; now it will find
+     * it on the array instead */
+    else if (n->next && iter->cur_linked == n->next)
+        iter->cur_linked = NULL;
+
+    val = n->ety.val;
+    __node_unlink(h, n, n_parent);
+    iter->prev = NULL;
+    return val;
+}
+
+int hashmap_retain(hashmap_t * h, hashmap_pred_f pred, void *udata)
+{
+    int ii, removed = 0;
+
+    for (ii = 0; ii < h->arraySize; ii++)
+    {
+        node_t *head = &((node_t*)h->array)[ii], *n_parent, *n;
+        int keep_head;
+
+        if (!head->ety.key)
+            continue;
+
+        keep_head = pred(udata, head->ety.key, head->ety.val);
+
+        for (n_parent = head, n = head->next; n; n = n_parent->next)
+        {
+            if (pred(udata, n->ety.key, n->ety.val))
+            {
+                n_parent = n;
+                continue;
+            }
+
+            __node_unlink(h, n, n_parent);
+            removed++;
+        }
+
+        /* a kept chain node, if any, moves up onto the array */
+        if (!keep_head)
+        {
+            __node_unlink(h, head, NULL);
+            removed++;
+        }
+    }
+
+    return removed;
+}
+
 void hashmap_iterator(
     hashmap_t * h __attribute__((__unused__)),
     hashmap_iterator_t * iter
@@ -459,6 +1226,66 @@ void hashmap_iterator(
 {
     iter->cur = 0;
     iter->cur_linked = NULL;
+    iter->end = -1;
+    iter->prev = NULL;
+}
+
+void hashmap_iterator_range(
+    hashmap_t * h __attribute__((__unused__)),
+    hashmap_iterator_t * iter,
+    int from,
+    int to
+    )
+{
+    iter->cur = from;
+    iter->cur_linked = NULL;
+    iter->end = to;
+    iter->prev = NULL;
+}
+
+void hashmap_iterator_partition(
+    hashmap_t * h,
+    hashmap_iterator_t * iters,
+    int *counts,
+    int k
+    )
+{
+    int ii, p = 0, from = 0, seen = 0, cut = 0;
+
+    assert(0 < k);
+
+    /* cut after the bucket that takes us past p + 1 k-ths of the items */
+    for (ii = 0; ii < h->arraySize && p < k - 1; ii++)
+    {
+        node_t *n = &((node_t*)h->array)[ii];
+
+        if (n->ety.key)
+            for (; n; n = n->next)
+                seen++;
+
+        if ((long)seen * k < (long)h->count * (p + 1))
+            continue;
+
+        hashmap_iterator_range(h, &iters[p], from, ii + 1);
+        if (counts)
+            counts[p] = seen - cut;
+        cut = seen;
+        from = ii + 1;
+        p++;
+    }
+
+    /* the last range takes the rest */
+    hashmap_iterator_range(h, &iters[p], from, h->arraySize);
+    if (counts)
+        counts[p] = h->count - cut;
+
+    /* if we ran out of buckets, the rest are empty */
+    for (p++; p < k; p++)
+    {
+        hashmap_iterator_range(h, &iters[p], h->arraySize, h->arraySize);
+        if (counts)
+            counts[p] = 0;
+    }
 }
 
 /*--------------------------------------------------------------79-characters-*/
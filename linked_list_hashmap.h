@@ -11,6 +11,18 @@ typedef struct
     void *val;
 } hashmap_entry_t;
 
+/* kinds of change passed to a hashmap_mutation_f */
+#define HASHMAP_OP_PUT 1
+#define HASHMAP_OP_REMOVE 2
+#define HASHMAP_OP_CLEAR 3
+
+/**
+ * Called after every change to a map.
+ * For HASHMAP_OP_PUT, key and val are the entry as it now is; for
+ * HASHMAP_OP_REMOVE, the entry taken out. HASHMAP_OP_CLEAR has neither. */
+typedef void (*hashmap_mutation_f) (void *udata, int op, unsigned long hash,
+                                    void *key, void *val);
+
 typedef struct
 {
     int count;
@@ -18,12 +30,45 @@ typedef struct
     void *array;
     func_longhash_f hash;
     func_longcmp_f compare;
+    /* reservoir of unused chain nodes */
+    void *free_nodes;
+    /* blocks the chain nodes were allocated from */
+    void *node_blocks;
+    /* a bit per bucket changed since hashmap_clear_dirty; NULL when not
+     * tracking */
+    unsigned long *dirty;
+    hashmap_mutation_f on_mutation;
+    void *mutation_udata;
 } hashmap_t;
 
+/**
+ * A map that can no longer change, laid out for lookups: the entries of
+ * bucket i are entries[offsets[i]] up to entries[offsets[i + 1]]. */
+typedef struct
+{
+    int count;
+    int nbuckets;
+    unsigned int *offsets;
+    hashmap_entry_t *entries;
+    func_longhash_f hash;
+    func_longcmp_f compare;
+} hashmap_frozen_t;
+
+typedef void (*hashmap_scan_f) (void *udata, void *key, void *val);
+
+/**
+ * @return non-zero to keep this entry */
+typedef int (*hashmap_pred_f) (void *udata, void *key, void *val);
+
 typedef struct
 {
     int cur;
     void *cur_linked;
+    /* bucket to stop before; negative for the end of the array */
+    int end;
+    /* node last returned by hashmap_iterator_next, and its bucket */
+    void *prev;
+    int prev_cur;
 } hashmap_iterator_t;
 
 hashmap_t *hashmap_new(
@@ -61,6 +106,39 @@ void hashmap_freeall(
     hashmap_t * hmap
 );
 
+/**
+ * Move every entry out into a contiguous array and empty the map.
+ * The array is reset with a memset, and the chain nodes are released in
+ * bulk rather than one at a time.
+ * The nodes go back to the allocator, so no other thread may be reading
+ * the map, even optimistically (see hashmap_seqlock.h).
+ * @param out : room for at least hashmap_count() entries
+ * @return number of entries written to out */
+int hashmap_drain(
+    hashmap_t * hmap,
+    hashmap_entry_t * out
+);
+
+/**
+ * Duplicate this map, without re-inserting anything.
+ * The bucket array is copied with one memcpy, and every chain is copied
+ * into a single contiguous block of nodes.
+ * Keys and values are shared, not copied.
+ * @return the new map, to be freed with hashmap_freeall */
+hashmap_t *hashmap_clone(
+    hashmap_t * hmap
+);
+
+/**
+ * Exchange the contents of two maps, in O(1).
+ * Hash and compare functions go along with the contents. Dirty tracking
+ * and the mutation hook stay with each map: every bucket becomes dirty,
+ * and the hook sees a clear, then a put for each entry now in the map. */
+void hashmap_swap(
+    hashmap_t * a,
+    hashmap_t * b
+);
+
 /**
  * Get this key's value.
  * @return key's item, otherwise NULL */
@@ -103,6 +181,101 @@ void *hashmap_put(
     void *val
 );
 
+/**
+ * Associate key with val, unless an equal key exists.
+ * @return val already associated with key; otherwise NULL */
+void *hashmap_put_if_absent(
+    hashmap_t * hmap,
+    void *key,
+    void *val
+);
+
+/**
+ * Associate key with val_new, if key is currently associated with expected.
+ * Values are compared by address.
+ * @return 1 if replaced, otherwise 0 */
+int hashmap_replace_if(
+    hashmap_t * hmap,
+    const void *key,
+    const void *expected,
+    void *val_new
+);
+
+/**
+ * Remove key, if it is currently associated with expected.
+ * Values are compared by address.
+ * @return 1 if removed, otherwise 0 */
+int hashmap_remove_if(
+    hashmap_t * hmap,
+    const void *key,
+    const void *expected
+);
+
+/**
+ * Insert key/val using a hash that was computed earlier.
+ * Neither the hash nor the compare function is called, and the map never
+ * grows: the key must not be in the map already, and the caller sizes the
+ * map. Used to restore saved maps.
+ * @param hash : what the map's hash function returns for key */
+void hashmap_insert_hashed(
+    hashmap_t * hmap,
+    unsigned long hash,
+    void *key,
+    void *val
+);
+
+/**
+ * Same as hashmap_put, with a hash that was computed earlier.
+ * @param hash : what the map's hash function returns for key */
+void *hashmap_put_hashed(
+    hashmap_t * hmap,
+    unsigned long hash,
+    void *key,
+    void *val
+);
+
+/**
+ * Same as hashmap_remove_entry, with a hash that was computed earlier.
+ * @param hash : what the map's hash function returns for key */
+void hashmap_remove_entry_hashed(
+    hashmap_t * hmap,
+    hashmap_entry_t * entry,
+    unsigned long hash,
+    const void *key
+);
+
+/**
+ * Start or stop recording which buckets change.
+ * Starting marks every bucket clean. Growing the map marks them all dirty. */
+void hashmap_track_dirty(
+    hashmap_t * hmap,
+    int on
+);
+
+/**
+ * Mark every bucket clean. */
+void hashmap_clear_dirty(
+    hashmap_t * hmap
+);
+
+/**
+ * @return first dirty bucket at or after from; -1 if there is none, or if
+ *         changes are not being tracked */
+int hashmap_next_dirty(
+    hashmap_t * hmap,
+    int from
+);
+
+/**
+ * Have fn called after every put, replace and remove that changes the map,
+ * and whenever the map is emptied. Growing the map is not a change.
+ * @param fn : NULL to remove the hook */
+void hashmap_set_mutation_hook(
+    hashmap_t * hmap,
+    hashmap_mutation_f fn,
+    void *udata
+);
+
 /**
  * Put this key/value entry into the hash */
 void hashmap_put_entry(
@@ -138,6 +311,38 @@ void *hashmap_iterator_next_value(
     hashmap_t * hmap,
     hashmap_iterator_t * iter);
 
+/**
+ * Iterate over up to max items at once.
+ * Entries are copied into out, with buckets and chain nodes prefetched
+ * ahead of the iterator.
+ * @return number of entries written to out; 0 at the end */
+int hashmap_iterator_next_batch(
+    hashmap_t * hmap,
+    hashmap_iterator_t * iter,
+    hashmap_entry_t * out,
+    int max
+);
+
+/**
+ * Remove the item last returned by hashmap_iterator_next.
+ * The node is unlinked directly, without hashing or comparing its key,
+ * and iteration carries on as if nothing happened.
+ * @return value of the removed item; NULL if there was none to remove */
+void *hashmap_iterator_remove(
+    hashmap_t * hmap,
+    hashmap_iterator_t * iter
+);
+
+/**
+ * Remove every entry for which pred returns 0, in one pass.
+ * The predicate must not change the map.
+ * @return number of items removed */
+int hashmap_retain(
+    hashmap_t * hmap,
+    hashmap_pred_f pred,
+    void *udata
+);
+
 /**
  * Initialise a new hash iterator over this hash
  * It is safe to remove items while iterating.  */
@@ -146,9 +351,99 @@ void hashmap_iterator(
     hashmap_iterator_t * iter
 );
 
+/**
+ * Initialise a hash iterator over the buckets from up to, but not
+ * including, to. */
+void hashmap_iterator_range(
+    hashmap_t * hmap,
+    hashmap_iterator_t * iter,
+    int from,
+    int to
+);
+
+/**
+ * Call fn on every entry in the buckets from up to, but not including, to.
+ * The callback must not change the map. */
+void hashmap_foreach_range(
+    hashmap_t * hmap,
+    int from,
+    int to,
+    hashmap_scan_f fn,
+    void *udata
+);
+
+/**
+ * Split the map into k iterators over disjoint bucket ranges, which
+ * together cover every item. Ranges are balanced by item count, not by
+ * bucket count, so each can be handed to its own thread.
+ * Takes one pass over the buckets and chains.
+ * @param counts : if not NULL, receives the number of items in each range
+ * @param k : number of iterators in iters */
+void hashmap_iterator_partition(
+    hashmap_t * hmap,
+    hashmap_iterator_t * iters,
+    int *counts,
+    int k
+);
+
+/**
+ * Visit every entry of one bucket, and say which bucket to visit next.
+ * Start with a cursor of 0 and feed each returned cursor back in.
+ * The map may be changed between calls, including growing by a
+ * power-of-two factor, as puts do. Every key that is in the map for the
+ * whole scan is visited at least once; some keys may be visited more than
+ * once. Growing by any other factor (see hashmap_increase_capacity) during
+ * a scan may skip keys.
+ * The callback must not change the map.
+ * @return cursor for the next call; 0 once the scan is complete */
+unsigned long hashmap_scan(
+    hashmap_t * hmap,
+    unsigned long cursor,
+    hashmap_scan_f fn,
+    void *udata
+);
+
+/**
+ * Turn a map that will only be read from now on into a hashmap_frozen_t.
+ * The entries are copied into one array, in bucket order, and hmap is
+ * freed. Nothing is hashed.
+ * @return the frozen map */
+hashmap_frozen_t *hashmap_freeze(
+    hashmap_t * hmap
+);
+
+/**
+ * @return number of items within the frozen map */
+int hashmap_frozen_count(
+    const hashmap_frozen_t * f
+);
+
+/**
+ * Get this key's value.
+ * @return key's item, otherwise NULL */
+void *hashmap_frozen_get(
+    const hashmap_frozen_t * f,
+    const void *key
+);
+
+/**
+ * Is this key inside this map?
+ * @return 1 if key is in hash, otherwise 0 */
+int hashmap_frozen_contains_key(
+    const hashmap_frozen_t * f,
+    const void *key
+);
+
+/**
+ * Free the frozen map. Keys and values are left alone. */
+void hashmap_frozen_free(
+    hashmap_frozen_t * f
+);
+
 /**
  * Increase hash capacity.
- * @param factor : increase by this factor */
+ * @param factor : increase by this factor. Use a power of two if a
+ *                 hashmap_scan may be in progress */
 void hashmap_increase_capacity(
     hashmap_t * hmap,
     unsigned int factor);
@@ -0,0 +1,266 @@
+
+
+/* This is auto-generated code. Edit at your own peril. */
+#include <stdio.h>
+#include "CuTest.h"
+
+
+extern void TestHashmapCdc_ReplicaFollowsChanges(CuTest*);
+extern void TestHashmapCdc_OverflowStopsStream(CuTest*);
+extern void TestHashmapCdc_ReplicaOverPipe(CuTest*);
+extern void TestHashmapCdc_ConcurrentConsumer(CuTest*);
+extern void TestHashmapCdc_SwapKeepsStream(CuTest*);
+extern void TestHashmapCdc_ShortWritesLoseNothing(CuTest*);
+extern void TestHashmapCdc_DamagedRecordIsNotReapplied(CuTest*);
+extern void TestHashmapCompact_New(CuTest*);
+extern void TestHashmapCompact_PutGetRemove(CuTest*);
+extern void TestHashmapCompact_CollidingKeys(CuTest*);
+extern void TestHashmapCompact_ReserveWithCollidingKeys(CuTest*);
+extern void TestHashmapCompact_ShiftedKeysSpreadOut(CuTest*);
+extern void TestHashmapCuckoo_New(CuTest*);
+extern void TestHashmapCuckoo_PutGetRemove(CuTest*);
+extern void TestHashmapCuckoo_HighLoad(CuTest*);
+extern void TestHashmapFc_RegisterHandsOutEachSlotOnce(CuTest*);
+extern void TestHashmapFc_Operations(CuTest*);
+extern void TestHashmapFc_ConcurrentWriters(CuTest*);
+extern void TestHashmapHopscotch_New(CuTest*);
+extern void TestHashmapHopscotch_PutGetRemove(CuTest*);
+extern void TestHashmapHopscotch_FillsPastNinetyPercent(CuTest*);
+extern void TestHashmapHopscotch_CrowdedTableEnd(CuTest*);
+extern void TestHashmapLinear_New(CuTest*);
+extern void TestHashmapLinear_PutGetRemove(CuTest*);
+extern void TestHashmapLinear_GrowsOneBucketAtATime(CuTest*);
+extern void TestHashmapLinear_ShiftedKeysSpreadOut(CuTest*);
+extern void TestHashmapMph_EveryKeyFound(CuTest*);
+extern void TestHashmapMph_SlotsAreMinimal(CuTest*);
+extern void TestHashmapMph_EmptyAndSingle(CuTest*);
+extern void TestHashmapMph_SameHashFails(CuTest*);
+extern void TestHashmapParallel_ForeachVisitsEverything(CuTest*);
+extern void TestHashmapParallel_ForeachOnEmptyMap(CuTest*);
+extern void TestHashmapParallel_NoBuckets(CuTest*);
+extern void TestHashmapParallel_ReduceOverSkewedChains(CuTest*);
+extern void TestHashmapSeqlock_New(CuTest*);
+extern void TestHashmapSeqlock_PutAndGet(CuTest*);
+extern void TestHashmapSeqlock_Remove(CuTest*);
+extern void TestHashmapSeqlock_GrowingKeepsItems(CuTest*);
+extern void TestHashmapSeqlock_ReadersSeeConsistentValuesDuringWrites(CuTest*);
+extern void TestHashmapSeqlock_ConditionalUpdates(CuTest*);
+extern void TestHashmapSeqlock_PutBatch(CuTest*);
+extern void TestHashmapShm_PutGetRemove(CuTest*);
+extern void TestHashmapShm_FullRegion(CuTest*);
+extern void TestHashmapShm_ForkedReaderSeesWrites(CuTest*);
+extern void TestHashmapShm_AttachAtAnotherAddress(CuTest*);
+extern void TestHashmapSnapshot_LoadRestoresEntries(CuTest*);
+extern void TestHashmapSnapshot_LoadDoesNotRehash(CuTest*);
+extern void TestHashmapSnapshot_LoadKeepsChainOrder(CuTest*);
+extern void TestHashmapSnapshot_LoadEmptyMap(CuTest*);
+extern void TestHashmapSnapshot_LoadRejectsBadFiles(CuTest*);
+extern void TestHashmapSnapshot_BackgroundSaveSeesMapAtFork(CuTest*);
+extern void TestHashmapSnapshot_BackgroundSaveReportsFailure(CuTest*);
+extern void TestHashmapSnapshot_DeltaWritesOnlyDirtyBuckets(CuTest*);
+extern void TestHashmapSnapshot_DeltaAfterGrowing(CuTest*);
+extern void TestHashmapSnapshot_DeltaNeedsTracking(CuTest*);
+extern void TestHashmapSplitorder_New(CuTest*);
+extern void TestHashmapSplitorder_PutAndGet(CuTest*);
+extern void TestHashmapSplitorder_DoublePutReplacesValue(CuTest*);
+extern void TestHashmapSplitorder_HandlesEqualHashes(CuTest*);
+extern void TestHashmapSplitorder_GrowsWithoutLosingItems(CuTest*);
+extern void TestHashmapSplitorder_ConcurrentWriters(CuTest*);
+extern void TestHashmapSplitorder_ConditionalUpdates(CuTest*);
+extern void TestHashmapSplitorder_ReplaceIfIsAtomic(CuTest*);
+extern void TestHashmapUnrolled_New(CuTest*);
+extern void TestHashmapUnrolled_PutGetRemove(CuTest*);
+extern void TestHashmapUnrolled_LongChains(CuTest*);
+extern void TestHashmapWal_ReopenReplaysLog(CuTest*);
+extern void TestHashmapWal_ReplayDoesNotRehash(CuTest*);
+extern void TestHashmapWal_CheckpointThenReplaySuffix(CuTest*);
+extern void TestHashmapWal_TornTailIsDropped(CuTest*);
+extern void TestHashmapWal_FailedGroupCommitIsReported(CuTest*);
+extern void TestHashmapWal_RecoveryFromSnapshotDoesNotRehash(CuTest*);
+extern void TestHashmapWbuf_PutIsBufferedUntilFlush(CuTest*);
+extern void TestHashmapWbuf_FlushesAtThreshold(CuTest*);
+extern void TestHashmapWbuf_LocalValueShadowsShared(CuTest*);
+extern void TestHashmapWbuf_MergedCountersAddUpAcrossThreads(CuTest*);
+extern void TestHashmaplinked_New(CuTest*);
+extern void TestHashmaplinked_Put(CuTest*);
+extern void TestHashmaplinked_PutEnsuresCapacity(CuTest*);
+extern void TestHashmaplinked_PutHandlesCollision(CuTest*);
+extern void TestHashmaplinked_GetHandlesCollisionByTraversingChain(CuTest*);
+extern void TestHashmaplinked_RemoveReturnsNullIfMissingAndTraversesChain(CuTest*);
+extern void TestHashmaplinked_RemoveHandlesCollision(CuTest*);
+extern void TestHashmaplinked_PutEntry(CuTest*);
+extern void TestHashmaplinked_Get(CuTest*);
+extern void TestHashmaplinked_ContainsKey(CuTest*);
+extern void TestHashmaplinked_DoublePut(CuTest*);
+extern void TestHashmaplinked_Get2(CuTest*);
+extern void TestHashmaplinked_IncreaseCapacityDoesNotBreakHashmap(CuTest*);
+extern void TestHashmaplinked_Remove(CuTest*);
+extern void TestHashmaplinked_ClearRemovesAll(CuTest*);
+extern void TestHashmaplinked_ClearHandlesCollision(CuTest*);
+extern void TestHashmaplinked_DoesNotHaveNextForEmptyIterator(CuTest*);
+extern void TestHashmaplinked_RemoveItemDoesNotHaveNextForEmptyIterator(CuTest*);
+extern void TestHashmaplinked_Iterate(CuTest*);
+extern void TestHashmaplinked_IterateHandlesCollisions(CuTest*);
+extern void TestHashmaplinked_IterateAndRemoveDoesntBreakIteration(CuTest*);
+extern void TestHashmaplinked_PutIfAbsentDoesNotReplace(CuTest*);
+extern void TestHashmaplinked_ReplaceIfOnlyReplacesExpected(CuTest*);
+extern void TestHashmaplinked_RemoveIfOnlyRemovesExpected(CuTest*);
+extern void TestHashmaplinked_ScanVisitsEverything(CuTest*);
+extern void TestHashmaplinked_ScanSurvivesCapacityIncrease(CuTest*);
+extern void TestHashmaplinked_ScanSurvivesPowerOfTwoGrowth(CuTest*);
+extern void TestHashmaplinked_IterateRange(CuTest*);
+extern void TestHashmaplinked_PartitionCoversEverythingOnce(CuTest*);
+extern void TestHashmaplinked_PartitionMoreWaysThanItems(CuTest*);
+extern void TestHashmaplinked_IterateInBatches(CuTest*);
+extern void TestHashmaplinked_BatchAndSingleIterationMix(CuTest*);
+extern void TestHashmaplinked_IteratorRemoveUnlinksAsItGoes(CuTest*);
+extern void TestHashmaplinked_IteratorRemoveEverything(CuTest*);
+extern void TestHashmaplinked_RetainKeepsMatchingItems(CuTest*);
+extern void TestHashmaplinked_DrainMovesEverythingOut(CuTest*);
+extern void TestHashmaplinked_SwapExchangesContents(CuTest*);
+extern void TestHashmaplinked_CloneIsIndependent(CuTest*);
+extern void TestHashmaplinked_DirtyBucketsFollowChanges(CuTest*);
+extern void TestHashmaplinked_MutationHookSeesChanges(CuTest*);
+extern void TestHashmaplinked_FreezeKeepsLookups(CuTest*);
+extern void TestHashmaplinked_FreezeEmptyMap(CuTest*);
+extern void TestHashmaplinked_SwapKeepsDirtyTracking(CuTest*);
+
+
+void RunAllTests(void) 
+{
+    CuString *output = CuStringNew();
+    CuSuite* suite = CuSuiteNew();
+
+
+    SUITE_ADD_TEST(suite, TestHashmapCdc_ReplicaFollowsChanges);
+    SUITE_ADD_TEST(suite, TestHashmapCdc_OverflowStopsStream);
+    SUITE_ADD_TEST(suite, TestHashmapCdc_ReplicaOverPipe);
+    SUITE_ADD_TEST(suite, TestHashmapCdc_ConcurrentConsumer);
+    SUITE_ADD_TEST(suite, TestHashmapCdc_SwapKeepsStream);
+    SUITE_ADD_TEST(suite, TestHashmapCdc_ShortWritesLoseNothing);
+    SUITE_ADD_TEST(suite, TestHashmapCdc_DamagedRecordIsNotReapplied);
+    SUITE_ADD_TEST(suite, TestHashmapCompact_New);
+    SUITE_ADD_TEST(suite, TestHashmapCompact_PutGetRemove);
+    SUITE_ADD_TEST(suite, TestHashmapCompact_CollidingKeys);
+    SUITE_ADD_TEST(suite, TestHashmapCompact_ReserveWithCollidingKeys);
+    SUITE_ADD_TEST(suite, TestHashmapCompact_ShiftedKeysSpreadOut);
+    SUITE_ADD_TEST(suite, TestHashmapCuckoo_New);
+    SUITE_ADD_TEST(suite, TestHashmapCuckoo_PutGetRemove);
+    SUITE_ADD_TEST(suite, TestHashmapCuckoo_HighLoad);
+    SUITE_ADD_TEST(suite, TestHashmapFc_RegisterHandsOutEachSlotOnce);
+    SUITE_ADD_TEST(suite, TestHashmapFc_Operations);
+    SUITE_ADD_TEST(suite, TestHashmapFc_ConcurrentWriters);
+    SUITE_ADD_TEST(suite, TestHashmapHopscotch_New);
+    SUITE_ADD_TEST(suite, TestHashmapHopscotch_PutGetRemove);
+    SUITE_ADD_TEST(suite, TestHashmapHopscotch_FillsPastNinetyPercent);
+    SUITE_ADD_TEST(suite, TestHashmapHopscotch_CrowdedTableEnd);
+    SUITE_ADD_TEST(suite, TestHashmapLinear_New);
+    SUITE_ADD_TEST(suite, TestHashmapLinear_PutGetRemove);
+    SUITE_ADD_TEST(suite, TestHashmapLinear_GrowsOneBucketAtATime);
+    SUITE_ADD_TEST(suite, TestHashmapLinear_ShiftedKeysSpreadOut);
+    SUITE_ADD_TEST(suite, TestHashmapMph_EveryKeyFound);
+    SUITE_ADD_TEST(suite, TestHashmapMph_SlotsAreMinimal);
+    SUITE_ADD_TEST(suite, TestHashmapMph_EmptyAndSingle);
+    SUITE_ADD_TEST(suite, TestHashmapMph_SameHashFails);
+    SUITE_ADD_TEST(suite, TestHashmapParallel_ForeachVisitsEverything);
+    SUITE_ADD_TEST(suite, TestHashmapParallel_ForeachOnEmptyMap);
+    SUITE_ADD_TEST(suite, TestHashmapParallel_NoBuckets);
+    SUITE_ADD_TEST(suite, TestHashmapParallel_ReduceOverSkewedChains);
+    SUITE_ADD_TEST(suite, TestHashmapSeqlock_New);
+    SUITE_ADD_TEST(suite, TestHashmapSeqlock_PutAndGet);
+    SUITE_ADD_TEST(suite, TestHashmapSeqlock_Remove);
+    SUITE_ADD_TEST(suite, TestHashmapSeqlock_GrowingKeepsItems);
+    SUITE_ADD_TEST(suite, TestHashmapSeqlock_ReadersSeeConsistentValuesDuringWrites);
+    SUITE_ADD_TEST(suite, TestHashmapSeqlock_ConditionalUpdates);
+    SUITE_ADD_TEST(suite, TestHashmapSeqlock_PutBatch);
+    SUITE_ADD_TEST(suite, TestHashmapShm_PutGetRemove);
+    SUITE_ADD_TEST(suite, TestHashmapShm_FullRegion);
+    SUITE_ADD_TEST(suite, TestHashmapShm_ForkedReaderSeesWrites);
+    SUITE_ADD_TEST(suite, TestHashmapShm_AttachAtAnotherAddress);
+    SUITE_ADD_TEST(suite, TestHashmapSnapshot_LoadRestoresEntries);
+    SUITE_ADD_TEST(suite, TestHashmapSnapshot_LoadDoesNotRehash);
+    SUITE_ADD_TEST(suite, TestHashmapSnapshot_LoadKeepsChainOrder);
+    SUITE_ADD_TEST(suite, TestHashmapSnapshot_LoadEmptyMap);
+    SUITE_ADD_TEST(suite, TestHashmapSnapshot_LoadRejectsBadFiles);
+    SUITE_ADD_TEST(suite, TestHashmapSnapshot_BackgroundSaveSeesMapAtFork);
+    SUITE_ADD_TEST(suite, TestHashmapSnapshot_BackgroundSaveReportsFailure);
+    SUITE_ADD_TEST(suite, TestHashmapSnapshot_DeltaWritesOnlyDirtyBuckets);
+    SUITE_ADD_TEST(suite, TestHashmapSnapshot_DeltaAfterGrowing);
+    SUITE_ADD_TEST(suite, TestHashmapSnapshot_DeltaNeedsTracking);
+    SUITE_ADD_TEST(suite, TestHashmapSplitorder_New);
+    SUITE_ADD_TEST(suite, TestHashmapSplitorder_PutAndGet);
+    SUITE_ADD_TEST(suite, TestHashmapSplitorder_DoublePutReplacesValue);
+    SUITE_ADD_TEST(suite, TestHashmapSplitorder_HandlesEqualHashes);
+    SUITE_ADD_TEST(suite, TestHashmapSplitorder_GrowsWithoutLosingItems);
+    SUITE_ADD_TEST(suite, TestHashmapSplitorder_ConcurrentWriters);
+    SUITE_ADD_TEST(suite, TestHashmapSplitorder_ConditionalUpdates);
+    SUITE_ADD_TEST(suite, TestHashmapSplitorder_ReplaceIfIsAtomic);
+    SUITE_ADD_TEST(suite, TestHashmapUnrolled_New);
+    SUITE_ADD_TEST(suite, TestHashmapUnrolled_PutGetRemove);
+    SUITE_ADD_TEST(suite, TestHashmapUnrolled_LongChains);
+    SUITE_ADD_TEST(suite, TestHashmapWal_ReopenReplaysLog);
+    SUITE_ADD_TEST(suite, TestHashmapWal_ReplayDoesNotRehash);
+    SUITE_ADD_TEST(suite, TestHashmapWal_CheckpointThenReplaySuffix);
+    SUITE_ADD_TEST(suite, TestHashmapWal_TornTailIsDropped);
+    SUITE_ADD_TEST(suite, TestHashmapWal_FailedGroupCommitIsReported);
+    SUITE_ADD_TEST(suite, TestHashmapWal_RecoveryFromSnapshotDoesNotRehash);
+    SUITE_ADD_TEST(suite, TestHashmapWbuf_PutIsBufferedUntilFlush);
+    SUITE_ADD_TEST(suite, TestHashmapWbuf_FlushesAtThreshold);
+    SUITE_ADD_TEST(suite, TestHashmapWbuf_LocalValueShadowsShared);
+    SUITE_ADD_TEST(suite, TestHashmapWbuf_MergedCountersAddUpAcrossThreads);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_New);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_Put);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_PutEnsuresCapacity);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_PutHandlesCollision);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_GetHandlesCollisionByTraversingChain);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_RemoveReturnsNullIfMissingAndTraversesChain);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_RemoveHandlesCollision);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_PutEntry);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_Get);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_ContainsKey);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_DoublePut);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_Get2);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_IncreaseCapacityDoesNotBreakHashmap);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_Remove);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_ClearRemovesAll);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_ClearHandlesCollision);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_DoesNotHaveNextForEmptyIterator);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_RemoveItemDoesNotHaveNextForEmptyIterator);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_Iterate);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_IterateHandlesCollisions);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_IterateAndRemoveDoesntBreakIteration);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_PutIfAbsentDoesNotReplace);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_ReplaceIfOnlyReplacesExpected);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_RemoveIfOnlyRemovesExpected);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_ScanVisitsEverything);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_ScanSurvivesCapacityIncrease);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_ScanSurvivesPowerOfTwoGrowth);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_IterateRange);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_PartitionCoversEverythingOnce);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_PartitionMoreWaysThanItems);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_IterateInBatches);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_BatchAndSingleIterationMix);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_IteratorRemoveUnlinksAsItGoes);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_IteratorRemoveEverything);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_RetainKeepsMatchingItems);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_DrainMovesEverythingOut);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_SwapExchangesContents);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_CloneIsIndependent);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_DirtyBucketsFollowChanges);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_MutationHookSeesChanges);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_FreezeKeepsLookups);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_FreezeEmptyMap);
+    SUITE_ADD_TEST(suite, TestHashmaplinked_SwapKeepsDirtyTracking);
+
+    CuSuiteRun(suite);
+    CuSuiteSummary(suite, output);
+    CuSuiteDetails(suite, output);
+    printf("%s\n", output->buffer);
+}
+
+int main()
+{
+    RunAllTests();
+    return 0;
+}
+
@@ -0,0 +1,380 @@
+#include <stdbool.h>
+#include <assert.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include "CuTest.h"
+
+#include "linked_list_hashmap.h"
+#include "hashmap_snapshot.h"
+#include "hashmap_wal.h"
+#include "hashmap_cdc.h"
+
+static unsigned long __uint_hash(
+    const void *e1
+    )
+{
+    const long i1 = (unsigned long)e1;
+
+    assert(i1 >= 0);
+    return i1;
+}
+
+static long __uint_compare(
+    const void *e1,
+    const void *e2
+    )
+{
+    const long i1 = (unsigned long)e1, i2 = (unsigned long)e2;
+
+    return i1 - i2;
+}
+
+static size_t __uint_encode(
+    void *udata __attribute__((__unused__)),
+    const void *obj,
+    void *buf,
+    size_t len
+    )
+{
+    if (sizeof(obj) <= len)
+        memcpy(buf, &obj, sizeof(obj));
+    return sizeof(obj);
+}
+
+static void *__uint_decode(
+    void *udata __attribute__((__unused__)),
+    const void *buf,
+    size_t len __attribute__((__unused__))
+    )
+{
+    void *obj;
+
+    memcpy(&obj, buf, sizeof(obj));
+    return obj;
+}
+
+static const hashmap_codec_t __codec = {
+    __uint_encode, __uint_decode, __uint_encode, __uint_decode, NULL
+};
+
+static int __same(
+    hashmap_t * a,
+    hashmap_t * b
+    )
+{
+    hashmap_iterator_t iter;
+
+    if (hashmap_count(a) != hashmap_count(b))
+        return 0;
+
+    hashmap_iterator(a, &iter);
+    while (hashmap_iterator_has_next(a, &iter))
+    {
+        void *key = hashmap_iterator_next(a, &iter);
+
+        if (hashmap_get(a, key) != hashmap_get(b, key))
+            return 0;
+    }
+
+    return 1;
+}
+
+void TestHashmapCdc_ReplicaFollowsChanges(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm, *replica;
+    hashmap_cdc_t *c;
+    unsigned long ii;
+
+    hm = hashmap_new(__uint_hash, __uint_compare, 11);
+    replica = hashmap_new(__uint_hash, __uint_compare, 11);
+    c = hashmap_cdc_new(hm, &__codec, 1 << 16);
+
+    for (ii = 1; ii <= 200; ii++)
+        hashmap_put(hm, (void*)ii, (void*)ii);
+    CuAssertTrue(tc, 200 == hashmap_cdc_apply(c, replica, NULL));
+    CuAssertTrue(tc, __same(hm, replica));
+
+    hashmap_put(hm, (void*)5, (void*)50);
+    hashmap_remove(hm, (void*)6);
+    hashmap_replace_if(hm, (void*)7, (void*)7, (void*)70);
+    hashmap_remove_if(hm, (void*)8, (void*)8);
+    /* no change, no record */
+    hashmap_put_if_absent(hm, (void*)9, (void*)90);
+    hashmap_remove(hm, (void*)1000);
+    CuAssertTrue(tc, 4 == hashmap_cdc_apply(c, replica, NULL));
+    CuAssertTrue(tc, __same(hm, replica));
+
+    hashmap_clear(hm);
+    hashmap_put(hm, (void*)1, (void*)2);
+    CuAssertTrue(tc, 2 == hashmap_cdc_apply(c, replica, NULL));
+    CuAssertTrue(tc, __same(hm, replica));
+    CuAssertTrue(tc, 0 == hashmap_cdc_apply(c, replica, NULL));
+    CuAssertTrue(tc, !hashmap_cdc_overflowed(c));
+
+    hashmap_cdc_free(c);
+    hashmap_freeall(hm);
+    hashmap_freeall(replica);
+}
+
+void TestHashmapCdc_OverflowStopsStream(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm, *replica;
+    hashmap_cdc_t *c;
+    unsigned long ii;
+
+    hm = hashmap_new(__uint_hash, __uint_compare, 11);
+    replica = hashmap_new(__uint_hash, __uint_compare, 11);
+    c = hashmap_cdc_new(hm, &__codec, 1024);
+
+    for (ii = 1; ii <= 100; ii++)
+        hashmap_put(hm, (void*)ii, (void*)ii);
+    CuAssertTrue(tc, hashmap_cdc_overflowed(c));
+    CuAssertTrue(tc, 0 < hashmap_cdc_apply(c, replica, NULL));
+    CuAssertTrue(tc, hashmap_count(replica) < 100);
+
+    /* nothing gets through until the replica is seeded again */
+    hashmap_put(hm, (void*)500, (void*)500);
+    CuAssertTrue(tc, 0 == hashmap_cdc_apply(c, replica, NULL));
+
+    hashmap_cdc_resume(c);
+    hashmap_freeall(replica);
+    replica = hashmap_clone(hm);
+    hashmap_put(hm, (void*)501, (void*)501);
+    CuAssertTrue(tc, !hashmap_cdc_overflowed(c));
+    CuAssertTrue(tc, 1 == hashmap_cdc_apply(c, replica, NULL));
+    CuAssertTrue(tc, __same(hm, replica));
+
+    hashmap_cdc_free(c);
+    hashmap_freeall(hm);
+    hashmap_freeall(replica);
+}
+
+void TestHashmapCdc_ReplicaOverPipe(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm, *replica;
+    hashmap_cdc_t *c;
+    hashmap_cdc_replica_t *r;
+    unsigned long ii;
+    int fds[2];
+
+    CuAssertTrue(tc, 0 == pipe(fds));
+    hm = hashmap_new(__uint_hash, __uint_compare, 11);
+    replica = hashmap_new(__uint_hash, __uint_compare, 11);
+    c = hashmap_cdc_new(hm, &__codec, 1 << 16);
+    r = hashmap_cdc_replica_new(replica, &__codec, NULL);
+
+    for (ii = 1; ii <= 300; ii++)
+        hashmap_put(hm, (void*)ii, (void*)(ii * 2));
+    for (ii = 1; ii <= 300; ii += 3)
+        hashmap_remove(hm, (void*)ii);
+    CuAssertTrue(tc, 0 < hashmap_cdc_write(c, fds[1]));
+    close(fds[1]);
+
+    while (!r->eof)
+        CuAssertTrue(tc, 0 <= hashmap_cdc_replica_read(r, fds[0]));
+    CuAssertTrue(tc, 0 == r->len);
+    CuAssertTrue(tc, __same(hm, replica));
+
+    close(fds[0]);
+    hashmap_cdc_replica_free(r);
+    hashmap_cdc_free(c);
+    hashmap_freeall(hm);
+    hashmap_freeall(replica);
+}
+
+typedef struct
+{
+    hashmap_cdc_t *c;
+    hashmap_t *replica;
+    int done;
+} consumer_t;
+
+static void *__consume(
+    void *arg
+    )
+{
+    consumer_t *con = arg;
+
+    while (!__atomic_load_n(&con->done, __ATOMIC_ACQUIRE))
+        hashmap_cdc_apply(con->c, con->replica, NULL);
+    hashmap_cdc_apply(con->c, con->replica, NULL);
+    return NULL;
+}
+
+void TestHashmapCdc_ConcurrentConsumer(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm;
+    consumer_t con;
+    pthread_t th;
+    unsigned long ii;
+
+    hm = hashmap_new(__uint_hash, __uint_compare, 11);
+    con.c = hashmap_cdc_new(hm, &__codec, 1 << 20);
+    con.replica = hashmap_new(__uint_hash, __uint_compare, 11);
+    con.done = 0;
+    pthread_create(&th, NULL, __consume, &con);
+
+    for (ii = 0; ii < 20000; ii++)
+    {
+        unsigned long k = ii % 1000 + 1;
+
+        if (ii % 7 == 0)
+            hashmap_remove(hm, (void*)k);
+        else
+            hashmap_put(hm, (void*)k, (void*)(ii + 1));
+    }
+
+    __atomic_store_n(&con.done, 1, __ATOMIC_RELEASE);
+    pthread_join(th, NULL);
+
+    CuAssertTrue(tc, !hashmap_cdc_overflowed(con.c));
+    CuAssertTrue(tc, __same(hm, con.replica));
+
+    hashmap_cdc_free(con.c);
+    hashmap_freeall(hm);
+    hashmap_freeall(con.replica);
+}
+
+void TestHashmapCdc_SwapKeepsStream(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm, *other, *replica;
+    hashmap_cdc_t *c;
+    unsigned long ii;
+
+    hm = hashmap_new(__uint_hash, __uint_compare, 11);
+    other = hashmap_new(__uint_hash, __uint_compare, 11);
+    replica = hashmap_new(__uint_hash, __uint_compare, 11);
+    c = hashmap_cdc_new(hm, &__codec, 1 << 16);
+
+    for (ii = 1; ii <= 10; ii++)
+        hashmap_put(hm, (void*)ii, (void*)ii);
+    for (ii = 100; ii <= 150; ii++)
+        hashmap_put(other, (void*)ii, (void*)ii);
+
+    /* the stream follows hm, whatever its contents become */
+    hashmap_swap(hm, other);
+    hashmap_put(hm, (void*)7, (void*)7);
+    hashmap_cdc_apply(c, replica, NULL);
+    CuAssertTrue(tc, 52 == hashmap_count(replica));
+    CuAssertTrue(tc, __same(hm, replica));
+
+    /* other never had the hook, and must not keep c alive */
+    hashmap_cdc_free(c);
+    hashmap_put(other, (void*)1000, (void*)1000);
+    hashmap_remove(other, (void*)1);
+    hashmap_put(hm, (void*)1000, (void*)1000);
+
+    hashmap_freeall(hm);
+    hashmap_freeall(other);
+    hashmap_freeall(replica);
+}
+
+void TestHashmapCdc_ShortWritesLoseNothing(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm, *replica;
+    hashmap_cdc_t *c;
+    hashmap_cdc_replica_t *r;
+    unsigned long ii;
+    ssize_t n;
+    int fds[2];
+
+    CuAssertTrue(tc, 0 == pipe(fds));
+    hm = hashmap_new(__uint_hash, __uint_compare, 11);
+    replica = hashmap_new(__uint_hash, __uint_compare, 11);
+    c = hashmap_cdc_new(hm, &__codec, 1 << 18);
+    r = hashmap_cdc_replica_new(replica, &__codec, NULL);
+
+    /* more than the pipe holds */
+    for (ii = 1; ii <= 4000; ii++)
+        hashmap_put(hm, (void*)ii, (void*)ii);
+
+    /* a failed write keeps everything waiting */
+    CuAssertTrue(tc, -1 == hashmap_cdc_write(c, -1));
+
+    fcntl(fds[1], F_SETFL, O_NONBLOCK);
+    while (0 < (n = hashmap_cdc_write(c, fds[1])))
+        CuAssertTrue(tc, 0 <= hashmap_cdc_replica_read(r, fds[0]));
+    CuAssertTrue(tc, 0 == n);
+    close(fds[1]);
+
+    while (!r->eof)
+        CuAssertTrue(tc, 0 <= hashmap_cdc_replica_read(r, fds[0]));
+    CuAssertTrue(tc, !hashmap_cdc_overflowed(c));
+    CuAssertTrue(tc, __same(hm, replica));
+
+    close(fds[0]);
+    hashmap_cdc_replica_free(r);
+    hashmap_cdc_free(c);
+    hashmap_freeall(hm);
+    hashmap_freeall(replica);
+}
+
+static int __releases = 0;
+
+static void __count_release(
+    void *udata __attribute__((__unused__)),
+    void *key __attribute__((__unused__)),
+    void *val __attribute__((__unused__))
+    )
+{
+    __releases++;
+}
+
+void TestHashmapCdc_DamagedRecordIsNotReapplied(
+    CuTest * tc
+    )
+{
+    hashmap_t *replica;
+    hashmap_cdc_replica_t *r;
+    char buf[256];
+    size_t len = 0;
+    int fds[2];
+
+    CuAssertTrue(tc, 0 == pipe(fds));
+    replica = hashmap_new(__uint_hash, __uint_compare, 11);
+    hashmap_put(replica, (void*)1, (void*)1);
+    r = hashmap_cdc_replica_new(replica, &__codec, __count_release);
+
+    len += hashmap_wal_encode(&__codec, HASHMAP_OP_PUT, 1, (void*)1,
+                              (void*)10, buf + len, sizeof(buf) - len);
+    len += hashmap_wal_encode(&__codec, HASHMAP_OP_PUT, 2, (void*)2,
+                              (void*)20, buf + len, sizeof(buf) - len);
+    /* the second change's value */
+    buf[len - 1] ^= 0xff;
+    len += hashmap_wal_encode(&__codec, HASHMAP_OP_PUT, 3, (void*)3,
+                              (void*)30, buf + len, sizeof(buf) - len);
+    CuAssertTrue(tc, (ssize_t)len == write(fds[1], buf, len));
+    close(fds[1]);
+
+    __releases = 0;
+    CuAssertTrue(tc, -1 == hashmap_cdc_replica_read(r, fds[0]));
+    CuAssertTrue(tc, 10 == (unsigned long)hashmap_get(replica, (void*)1));
+    CuAssertTrue(tc, 1 == __releases);
+
+    /* the change before the damage is not applied, or released, again */
+    CuAssertTrue(tc, -1 == hashmap_cdc_replica_read(r, fds[0]));
+    CuAssertTrue(tc, 1 == __releases);
+    CuAssertTrue(tc, NULL == hashmap_get(replica, (void*)2));
+    CuAssertTrue(tc, NULL == hashmap_get(replica, (void*)3));
+
+    close(fds[0]);
+    hashmap_cdc_replica_free(r);
+    hashmap_freeall(replica);
+}
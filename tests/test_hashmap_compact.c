@@ -0,0 +1,149 @@
+#include <stdbool.h>
+#include <assert.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "CuTest.h"
+
+#include "hashmap_compact.h"
+
+static unsigned long __uint_hash(
+    const void *e1
+    )
+{
+    const long i1 = (unsigned long)e1;
+
+    assert(i1 >= 0);
+    return i1;
+}
+
+static long __uint_compare(
+    const void *e1,
+    const void *e2
+    )
+{
+    const long i1 = (unsigned long)e1, i2 = (unsigned long)e2;
+
+    return i1 - i2;
+}
+
+void TestHashmapCompact_New(
+    CuTest * tc
+    )
+{
+    hashmap_compact_t *hm;
+
+    hm = hashmap_compact_new(__uint_hash, __uint_compare, 100);
+    CuAssertTrue(tc, 0 == hashmap_compact_count(hm));
+    CuAssertTrue(tc, 100 <= hashmap_compact_size(hm));
+    CuAssertTrue(tc, NULL == hashmap_compact_get(hm, (void*)1));
+    CuAssertTrue(tc, NULL == hashmap_compact_remove(hm, (void*)1));
+    hashmap_compact_freeall(hm);
+}
+
+void TestHashmapCompact_PutGetRemove(
+    CuTest * tc
+    )
+{
+    hashmap_compact_t *hm;
+    unsigned long ii;
+
+    hm = hashmap_compact_new(__uint_hash, __uint_compare, 0);
+    for (ii = 1; ii <= 5000; ii++)
+        CuAssertTrue(tc, NULL == hashmap_compact_put(hm, (void*)ii,
+                                                     (void*)(ii + 1)));
+    CuAssertTrue(tc, 5000 == hashmap_compact_count(hm));
+    for (ii = 1; ii <= 5000; ii++)
+        CuAssertTrue(tc, ii + 1 ==
+                     (unsigned long)hashmap_compact_get(hm, (void*)ii));
+
+    CuAssertTrue(tc, 6 == (unsigned long)hashmap_compact_put(hm, (void*)5,
+                                                             (void*)9));
+    CuAssertTrue(tc, 9 == (unsigned long)hashmap_compact_get(hm, (void*)5));
+
+    for (ii = 1; ii <= 5000; ii += 2)
+        CuAssertTrue(tc, NULL != hashmap_compact_remove(hm, (void*)ii));
+    CuAssertTrue(tc, NULL == hashmap_compact_remove(hm, (void*)1));
+    CuAssertTrue(tc, 2500 == hashmap_compact_count(hm));
+    for (ii = 1; ii <= 5000; ii++)
+        CuAssertTrue(tc, (ii % 2 == 0) ==
+                     hashmap_compact_contains_key(hm, (void*)ii));
+
+    hashmap_compact_freeall(hm);
+}
+
+void TestHashmapCompact_CollidingKeys(
+    CuTest * tc
+    )
+{
+    hashmap_compact_t *hm;
+    unsigned long ii;
+
+    /* these differ only in their high bits */
+    hm = hashmap_compact_new(__uint_hash, __uint_compare, 0);
+    for (ii = 1; ii <= 1000; ii++)
+        hashmap_compact_put(hm, (void*)(ii << 20), (void*)ii);
+
+    /* removals move the last entry around; chains must follow it */
+    for (ii = 1; ii <= 1000; ii += 3)
+        CuAssertTrue(tc, ii ==
+                     (unsigned long)hashmap_compact_remove(hm,
+                                                           (void*)(ii << 20)));
+    for (ii = 1; ii <= 1000; ii++)
+        CuAssertTrue(tc, (ii % 3 == 1 ? 0 : ii) ==
+                     (unsigned long)hashmap_compact_get(hm, (void*)(ii << 20)));
+
+    for (ii = 1; ii <= 1000; ii++)
+        hashmap_compact_remove(hm, (void*)(ii << 20));
+    CuAssertTrue(tc, 0 == hashmap_compact_count(hm));
+
+    hashmap_compact_freeall(hm);
+}
+
+void TestHashmapCompact_ReserveWithCollidingKeys(
+    CuTest * tc
+    )
+{
+    hashmap_compact_t *hm;
+    unsigned long ii;
+
+    /* the entries fill up before the buckets need to double */
+    hm = hashmap_compact_new(__uint_hash, __uint_compare, 3);
+    for (ii = 1; ii <= 100; ii++)
+        CuAssertTrue(tc, NULL == hashmap_compact_put(hm, (void*)(ii << 20),
+                                                     (void*)ii));
+    CuAssertTrue(tc, 100 == hashmap_compact_count(hm));
+    for (ii = 1; ii <= 100; ii++)
+        CuAssertTrue(tc, ii ==
+                     (unsigned long)hashmap_compact_get(hm, (void*)(ii << 20)));
+
+    hashmap_compact_freeall(hm);
+}
+
+void TestHashmapCompact_ShiftedKeysSpreadOut(
+    CuTest * tc
+    )
+{
+    hashmap_compact_t *hm;
+    unsigned long ii;
+    uint32_t b, longest = 0;
+
+    hm = hashmap_compact_new(__uint_hash, __uint_compare, 1000);
+    for (ii = 1; ii <= 1000; ii++)
+        hashmap_compact_put(hm, (void*)(ii << 20), (void*)ii);
+
+    /* keys that differ only in high bits still get their own buckets */
+    for (b = 0; b < hm->nbuckets; b++)
+    {
+        uint32_t len = 0, at;
+
+        for (at = hm->heads[b]; at; at = hm->links[at - 1])
+            len++;
+        if (longest < len)
+            longest = len;
+    }
+    CuAssertTrue(tc, longest <= 8);
+
+    hashmap_compact_freeall(hm);
+}
@@ -0,0 +1,91 @@
+#include <stdbool.h>
+#include <assert.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "CuTest.h"
+
+#include "hashmap_cuckoo.h"
+
+static unsigned long __uint_hash(
+    const void *e1
+    )
+{
+    const long i1 = (unsigned long)e1;
+
+    assert(i1 >= 0);
+    return i1;
+}
+
+static long __uint_compare(
+    const void *e1,
+    const void *e2
+    )
+{
+    const long i1 = (unsigned long)e1, i2 = (unsigned long)e2;
+
+    return i1 - i2;
+}
+
+void TestHashmapCuckoo_New(
+    CuTest * tc
+    )
+{
+    hashmap_cuckoo_t *hm;
+
+    hm = hashmap_cuckoo_new(__uint_hash, __uint_compare, 100);
+    CuAssertTrue(tc, 0 == hashmap_cuckoo_count(hm));
+    CuAssertTrue(tc, 100 <= hashmap_cuckoo_size(hm));
+    CuAssertTrue(tc, NULL == hashmap_cuckoo_get(hm, (void*)1));
+    hashmap_cuckoo_freeall(hm);
+}
+
+void TestHashmapCuckoo_PutGetRemove(
+    CuTest * tc
+    )
+{
+    hashmap_cuckoo_t *hm;
+    unsigned long ii;
+
+    hm = hashmap_cuckoo_new(__uint_hash, __uint_compare, 8);
+    for (ii = 1; ii <= 5000; ii++)
+        CuAssertTrue(tc, NULL == hashmap_cuckoo_put(hm, (void*)ii, (void*)(ii + 1)));
+    CuAssertTrue(tc, 5000 == hashmap_cuckoo_count(hm));
+
+    for (ii = 1; ii <= 5000; ii++)
+        CuAssertTrue(tc, ii + 1 == (unsigned long)hashmap_cuckoo_get(hm, (void*)ii));
+
+    CuAssertTrue(tc, 6 == (unsigned long)hashmap_cuckoo_put(hm, (void*)5, (void*)9));
+    CuAssertTrue(tc, 9 == (unsigned long)hashmap_cuckoo_get(hm, (void*)5));
+    CuAssertTrue(tc, 5000 == hashmap_cuckoo_count(hm));
+
+    for (ii = 1; ii <= 5000; ii += 2)
+        CuAssertTrue(tc, NULL != hashmap_cuckoo_remove(hm, (void*)ii));
+    CuAssertTrue(tc, NULL == hashmap_cuckoo_remove(hm, (void*)1));
+    CuAssertTrue(tc, 2500 == hashmap_cuckoo_count(hm));
+    for (ii = 1; ii <= 5000; ii++)
+        CuAssertTrue(tc, (ii % 2 == 0) == hashmap_cuckoo_contains_key(hm, (void*)ii));
+
+    hashmap_cuckoo_freeall(hm);
+}
+
+void TestHashmapCuckoo_HighLoad(
+    CuTest * tc
+    )
+{
+    hashmap_cuckoo_t *hm;
+    unsigned long ii;
+
+    /* keys that share their low bits, so the first buckets collide */
+    hm = hashmap_cuckoo_new(__uint_hash, __uint_compare, 8);
+    for (ii = 1; ii <= 2000; ii++)
+        hashmap_cuckoo_put(hm, (void*)(ii << 12), (void*)ii);
+
+    CuAssertTrue(tc, 2000 == hashmap_cuckoo_count(hm));
+    for (ii = 1; ii <= 2000; ii++)
+        CuAssertTrue(tc, ii == (unsigned long)hashmap_cuckoo_get(hm, (void*)(ii << 12)));
+    CuAssertTrue(tc, 2000 < hashmap_cuckoo_size(hm));
+
+    hashmap_cuckoo_freeall(hm);
+}
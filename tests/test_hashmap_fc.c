@@ -0,0 +1,140 @@
+#include <stdbool.h>
+#include <assert.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include "CuTest.h"
+
+#include "hashmap_fc.h"
+
+static unsigned long __uint_hash(
+    const void *e1
+    )
+{
+    const long i1 = (unsigned long)e1;
+
+    assert(i1 >= 0);
+    return i1;
+}
+
+static long __uint_compare(
+    const void *e1,
+    const void *e2
+    )
+{
+    const long i1 = (unsigned long)e1, i2 = (unsigned long)e2;
+
+    return i1 - i2;
+}
+
+void TestHashmapFc_RegisterHandsOutEachSlotOnce(
+    CuTest * tc
+    )
+{
+    hashmap_fc_t *hm;
+    int a, b;
+
+    hm = hashmap_fc_new(__uint_hash, __uint_compare, 11, 2);
+
+    a = hashmap_fc_register(hm);
+    b = hashmap_fc_register(hm);
+    CuAssertTrue(tc, 0 <= a && 0 <= b && a != b);
+    CuAssertTrue(tc, -1 == hashmap_fc_register(hm));
+
+    hashmap_fc_unregister(hm, a);
+    CuAssertTrue(tc, a == hashmap_fc_register(hm));
+
+    hashmap_fc_freeall(hm);
+}
+
+void TestHashmapFc_Operations(
+    CuTest * tc
+    )
+{
+    hashmap_fc_t *hm;
+    int slot;
+
+    hm = hashmap_fc_new(__uint_hash, __uint_compare, 11, 1);
+    slot = hashmap_fc_register(hm);
+
+    CuAssertTrue(tc, 0 == hashmap_fc_put(hm, slot, (void*)50, (void*)92));
+    CuAssertTrue(tc, 92 == (unsigned long)hashmap_fc_get(hm, slot, (void*)50));
+    CuAssertTrue(tc, 92 == (unsigned long)
+                 hashmap_fc_put_if_absent(hm, slot, (void*)50, (void*)93));
+    CuAssertTrue(tc, 1 == hashmap_fc_replace_if(hm, slot, (void*)50,
+                                                (void*)92, (void*)94));
+    CuAssertTrue(tc, 0 == hashmap_fc_remove_if(hm, slot, (void*)50,
+                                               (void*)92));
+    CuAssertTrue(tc, 1 == hashmap_fc_count(hm));
+    CuAssertTrue(tc, 94 == (unsigned long)hashmap_fc_remove(hm, slot,
+                                                            (void*)50));
+    CuAssertTrue(tc, 0 == hashmap_fc_count(hm));
+
+    hashmap_fc_unregister(hm, slot);
+    hashmap_fc_freeall(hm);
+}
+
+typedef struct
+{
+    hashmap_fc_t *hm;
+    unsigned long from;
+} __writer_t;
+
+static void *__writer(void *arg)
+{
+    __writer_t *w = arg;
+    int slot = hashmap_fc_register(w->hm);
+    unsigned long ii;
+
+    for (ii = w->from; ii < w->from + 1000; ii++)
+    {
+        void *val;
+
+        hashmap_fc_put(w->hm, slot, (void*)ii, (void*)(ii + 1));
+
+        /* everybody also hammers one hot counter */
+        do
+            val = hashmap_fc_get(w->hm, slot, (void*)1);
+        while (!hashmap_fc_replace_if(w->hm, slot, (void*)1, val,
+                                      (void*)((unsigned long)val + 1)));
+    }
+
+    hashmap_fc_unregister(w->hm, slot);
+    return NULL;
+}
+
+void TestHashmapFc_ConcurrentWriters(
+    CuTest * tc
+    )
+{
+    pthread_t threads[4];
+    __writer_t w[4];
+    hashmap_fc_t *hm;
+    unsigned long ii;
+    int jj, slot;
+
+    hm = hashmap_fc_new(__uint_hash, __uint_compare, 11, 5);
+    slot = hashmap_fc_register(hm);
+    hashmap_fc_put(hm, slot, (void*)1, (void*)1);
+
+    for (jj = 0; jj < 4; jj++)
+    {
+        w[jj].hm = hm;
+        w[jj].from = 2 + jj * 1000;
+        pthread_create(&threads[jj], NULL, __writer, &w[jj]);
+    }
+
+    for (jj = 0; jj < 4; jj++)
+        pthread_join(threads[jj], NULL);
+
+    CuAssertTrue(tc, 4001 == hashmap_fc_count(hm));
+    CuAssertTrue(tc, 4001 == (unsigned long)hashmap_fc_get(hm, slot, (void*)1));
+    for (ii = 2; ii < 4002; ii++)
+        CuAssertTrue(tc, ii + 1 ==
+                     (unsigned long)hashmap_fc_get(hm, slot, (void*)ii));
+
+    hashmap_fc_unregister(hm, slot);
+    hashmap_fc_freeall(hm);
+}
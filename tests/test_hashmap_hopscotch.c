@@ -0,0 +1,140 @@
+#include <stdbool.h>
+#include <assert.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "CuTest.h"
+
+#include "hashmap_hopscotch.h"
+
+static unsigned long __uint_hash(
+    const void *e1
+    )
+{
+    const long i1 = (unsigned long)e1;
+
+    assert(i1 >= 0);
+    return i1;
+}
+
+static long __uint_compare(
+    const void *e1,
+    const void *e2
+    )
+{
+    const long i1 = (unsigned long)e1, i2 = (unsigned long)e2;
+
+    return i1 - i2;
+}
+
+void TestHashmapHopscotch_New(
+    CuTest * tc
+    )
+{
+    hashmap_hopscotch_t *hm;
+
+    hm = hashmap_hopscotch_new(__uint_hash, __uint_compare, 100);
+    CuAssertTrue(tc, 0 == hashmap_hopscotch_count(hm));
+    CuAssertTrue(tc, 100 <= hashmap_hopscotch_size(hm));
+    CuAssertTrue(tc, NULL == hashmap_hopscotch_get(hm, (void*)1));
+    hashmap_hopscotch_freeall(hm);
+}
+
+void TestHashmapHopscotch_PutGetRemove(
+    CuTest * tc
+    )
+{
+    hashmap_hopscotch_t *hm;
+    unsigned long ii;
+
+    hm = hashmap_hopscotch_new(__uint_hash, __uint_compare, 8);
+    for (ii = 1; ii <= 5000; ii++)
+        CuAssertTrue(tc, NULL == hashmap_hopscotch_put(hm, (void*)ii,
+                                                       (void*)(ii + 1)));
+    CuAssertTrue(tc, 5000 == hashmap_hopscotch_count(hm));
+    for (ii = 1; ii <= 5000; ii++)
+        CuAssertTrue(tc, ii + 1 ==
+                     (unsigned long)hashmap_hopscotch_get(hm, (void*)ii));
+
+    CuAssertTrue(tc, 6 == (unsigned long)hashmap_hopscotch_put(hm, (void*)5,
+                                                               (void*)9));
+    CuAssertTrue(tc, 9 == (unsigned long)hashmap_hopscotch_get(hm, (void*)5));
+
+    for (ii = 1; ii <= 5000; ii += 2)
+        CuAssertTrue(tc, NULL != hashmap_hopscotch_remove(hm, (void*)ii));
+    CuAssertTrue(tc, NULL == hashmap_hopscotch_remove(hm, (void*)1));
+    CuAssertTrue(tc, 2500 == hashmap_hopscotch_count(hm));
+    for (ii = 1; ii <= 5000; ii++)
+        CuAssertTrue(tc, (ii % 2 == 0) ==
+                     hashmap_hopscotch_contains_key(hm, (void*)ii));
+
+    /* freed slots are used again */
+    for (ii = 1; ii <= 5000; ii += 2)
+        hashmap_hopscotch_put(hm, (void*)ii, (void*)ii);
+    CuAssertTrue(tc, 5000 == hashmap_hopscotch_count(hm));
+    for (ii = 1; ii <= 5000; ii++)
+        CuAssertTrue(tc, hashmap_hopscotch_contains_key(hm, (void*)ii));
+
+    hashmap_hopscotch_freeall(hm);
+}
+
+void TestHashmapHopscotch_FillsPastNinetyPercent(
+    CuTest * tc
+    )
+{
+    hashmap_hopscotch_t *hm;
+    unsigned long ii;
+    int size;
+
+    hm = hashmap_hopscotch_new(__uint_hash, __uint_compare, 4000);
+    size = hashmap_hopscotch_size(hm);
+
+    for (ii = 1; ii <= (unsigned long)size * 9 / 10 + 1; ii++)
+        hashmap_hopscotch_put(hm, (void*)(ii << 12), (void*)ii);
+
+    /* no growing needed */
+    CuAssertTrue(tc, size == hashmap_hopscotch_size(hm));
+    for (ii = 1; ii <= (unsigned long)size * 9 / 10 + 1; ii++)
+        CuAssertTrue(tc, ii ==
+                     (unsigned long)hashmap_hopscotch_get(hm, (void*)(ii << 12)));
+
+    hashmap_hopscotch_freeall(hm);
+}
+
+/* the map's hash spreader, to pick keys with a given home */
+static unsigned long __mix(
+    unsigned long x
+    )
+{
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9UL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebUL;
+    return x ^ (x >> 31);
+}
+
+void TestHashmapHopscotch_CrowdedTableEnd(
+    CuTest * tc
+    )
+{
+    hashmap_hopscotch_t *hm;
+    unsigned long keys[40], ii, n;
+
+    hm = hashmap_hopscotch_new(__uint_hash, __uint_compare, 60);
+    CuAssertTrue(tc, 64 == hashmap_hopscotch_size(hm));
+
+    /* a full neighbourhood, plus more, all at the second-last home */
+    for (ii = 1, n = 0; n < 40; ii++)
+        if ((__mix(ii) & 63) == 62)
+            keys[n++] = ii;
+
+    for (ii = 0; ii < n; ii++)
+        CuAssertTrue(tc, NULL == hashmap_hopscotch_put(hm, (void*)keys[ii],
+                                                       (void*)keys[ii]));
+    CuAssertTrue(tc, 40 == hashmap_hopscotch_count(hm));
+    for (ii = 0; ii < n; ii++)
+        CuAssertTrue(tc, keys[ii] ==
+                     (unsigned long)hashmap_hopscotch_get(hm,
+                                                          (void*)keys[ii]));
+
+    hashmap_hopscotch_freeall(hm);
+}
@@ -0,0 +1,123 @@
+#include <stdbool.h>
+#include <assert.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "CuTest.h"
+
+#include "hashmap_linear.h"
+
+static int __hash_calls = 0;
+
+static unsigned long __uint_hash(
+    const void *e1
+    )
+{
+    const long i1 = (unsigned long)e1;
+
+    assert(i1 >= 0);
+    __hash_calls++;
+    return i1;
+}
+
+static long __uint_compare(
+    const void *e1,
+    const void *e2
+    )
+{
+    const long i1 = (unsigned long)e1, i2 = (unsigned long)e2;
+
+    return i1 - i2;
+}
+
+void TestHashmapLinear_New(
+    CuTest * tc
+    )
+{
+    hashmap_linear_t *hm;
+
+    hm = hashmap_linear_new(__uint_hash, __uint_compare, 100);
+    CuAssertTrue(tc, 0 == hashmap_linear_count(hm));
+    CuAssertTrue(tc, 128 == hashmap_linear_size(hm));
+    CuAssertTrue(tc, NULL == hashmap_linear_get(hm, (void*)1));
+    hashmap_linear_freeall(hm);
+}
+
+void TestHashmapLinear_PutGetRemove(
+    CuTest * tc
+    )
+{
+    hashmap_linear_t *hm;
+    unsigned long ii;
+
+    hm = hashmap_linear_new(__uint_hash, __uint_compare, 4);
+    for (ii = 1; ii <= 5000; ii++)
+        CuAssertTrue(tc, NULL == hashmap_linear_put(hm, (void*)ii, (void*)(ii + 1)));
+    CuAssertTrue(tc, 5000 == hashmap_linear_count(hm));
+    for (ii = 1; ii <= 5000; ii++)
+        CuAssertTrue(tc, ii + 1 == (unsigned long)hashmap_linear_get(hm, (void*)ii));
+
+    CuAssertTrue(tc, 6 == (unsigned long)hashmap_linear_put(hm, (void*)5, (void*)9));
+    CuAssertTrue(tc, 9 == (unsigned long)hashmap_linear_get(hm, (void*)5));
+
+    for (ii = 1; ii <= 5000; ii += 2)
+        CuAssertTrue(tc, NULL != hashmap_linear_remove(hm, (void*)ii));
+    CuAssertTrue(tc, NULL == hashmap_linear_remove(hm, (void*)1));
+    CuAssertTrue(tc, 2500 == hashmap_linear_count(hm));
+    for (ii = 1; ii <= 5000; ii++)
+        CuAssertTrue(tc, (ii % 2 == 0) == hashmap_linear_contains_key(hm, (void*)ii));
+
+    hashmap_linear_freeall(hm);
+}
+
+void TestHashmapLinear_GrowsOneBucketAtATime(
+    CuTest * tc
+    )
+{
+    hashmap_linear_t *hm;
+    unsigned long ii;
+    int size;
+
+    hm = hashmap_linear_new(__uint_hash, __uint_compare, 4);
+    size = hashmap_linear_size(hm);
+    for (ii = 1; ii <= 3000; ii++)
+    {
+        __hash_calls = 0;
+        hashmap_linear_put(hm, (void*)ii, (void*)ii);
+
+        /* a split rehashes nothing */
+        CuAssertTrue(tc, 1 == __hash_calls);
+        CuAssertTrue(tc, hashmap_linear_size(hm) - size <= 1);
+        size = hashmap_linear_size(hm);
+        CuAssertTrue(tc, hashmap_linear_count(hm) <= size);
+    }
+    CuAssertTrue(tc, 3000 == size);
+
+    hashmap_linear_freeall(hm);
+}
+
+void TestHashmapLinear_ShiftedKeysSpreadOut(
+    CuTest * tc
+    )
+{
+    hashmap_linear_t *hm;
+    unsigned long ii;
+    int b, used = 0;
+
+    hm = hashmap_linear_new(__uint_hash, __uint_compare, 4);
+    for (ii = 1; ii <= 1000; ii++)
+        hashmap_linear_put(hm, (void*)(ii << 20), (void*)ii);
+
+    /* keys that differ only in high bits still fill most buckets; segments
+     * hold 256 buckets */
+    for (b = 0; b < hashmap_linear_size(hm); b++)
+        used += NULL != hm->segments[b / 256][b % 256];
+    CuAssertTrue(tc, hashmap_linear_size(hm) / 2 < used);
+
+    for (ii = 1; ii <= 1000; ii++)
+        CuAssertTrue(tc, ii ==
+                     (unsigned long)hashmap_linear_get(hm, (void*)(ii << 20)));
+
+    hashmap_linear_freeall(hm);
+}
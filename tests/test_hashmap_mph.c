@@ -0,0 +1,125 @@
+#include <stdbool.h>
+#include <assert.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "CuTest.h"
+
+#include "linked_list_hashmap.h"
+#include "hashmap_mph.h"
+
+static unsigned long __uint_hash(
+    const void *e1
+    )
+{
+    const long i1 = (unsigned long)e1;
+
+    assert(i1 >= 0);
+    return i1;
+}
+
+static long __uint_compare(
+    const void *e1,
+    const void *e2
+    )
+{
+    const long i1 = (unsigned long)e1, i2 = (unsigned long)e2;
+
+    return i1 - i2;
+}
+
+static unsigned long __bad_hash(
+    const void *e1
+    )
+{
+    return (unsigned long)e1 / 2;
+}
+
+void TestHashmapMph_EveryKeyFound(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm;
+    hashmap_mph_t *m;
+    unsigned long ii;
+
+    hm = hashmap_new(__uint_hash, __uint_compare, 11);
+    for (ii = 1; ii <= 10000; ii++)
+        hashmap_put(hm, (void*)(ii * 3), (void*)ii);
+
+    m = hashmap_mph_build(hm);
+    CuAssertPtrNotNull(tc, m);
+    CuAssertTrue(tc, 10000 == hashmap_mph_count(m));
+    for (ii = 1; ii <= 10000; ii++)
+        CuAssertTrue(tc, ii == (unsigned long)hashmap_mph_get(m, (void*)(ii * 3)));
+
+    /* keys not in the set */
+    CuAssertTrue(tc, NULL == hashmap_mph_get(m, (void*)1));
+    CuAssertTrue(tc, !hashmap_mph_contains_key(m, (void*)30001));
+    CuAssertTrue(tc, hashmap_mph_contains_key(m, (void*)30000));
+
+    /* the source map is untouched */
+    CuAssertTrue(tc, 10000 == hashmap_count(hm));
+
+    hashmap_mph_free(m);
+    hashmap_freeall(hm);
+}
+
+void TestHashmapMph_SlotsAreMinimal(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm;
+    hashmap_mph_t *m;
+    unsigned long ii;
+
+    hm = hashmap_new(__uint_hash, __uint_compare, 11);
+    for (ii = 1; ii <= 1000; ii++)
+        hashmap_put(hm, (void*)ii, (void*)ii);
+
+    m = hashmap_mph_build(hm);
+    CuAssertPtrNotNull(tc, m);
+
+    /* every slot holds a key */
+    for (ii = 0; ii < 1000; ii++)
+        CuAssertPtrNotNull(tc, m->entries[ii].key);
+    CuAssertTrue(tc, m->nbuckets * sizeof(unsigned int) * 8 / 1000 < 8);
+
+    hashmap_mph_free(m);
+    hashmap_freeall(hm);
+}
+
+void TestHashmapMph_EmptyAndSingle(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm;
+    hashmap_mph_t *m;
+
+    hm = hashmap_new(__uint_hash, __uint_compare, 11);
+    m = hashmap_mph_build(hm);
+    CuAssertTrue(tc, 0 == hashmap_mph_count(m));
+    CuAssertTrue(tc, NULL == hashmap_mph_get(m, (void*)1));
+    hashmap_mph_free(m);
+
+    hashmap_put(hm, (void*)7, (void*)8);
+    m = hashmap_mph_build(hm);
+    CuAssertTrue(tc, 8 == (unsigned long)hashmap_mph_get(m, (void*)7));
+    CuAssertTrue(tc, NULL == hashmap_mph_get(m, (void*)6));
+    hashmap_mph_free(m);
+    hashmap_freeall(hm);
+}
+
+void TestHashmapMph_SameHashFails(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm;
+
+    hm = hashmap_new(__bad_hash, __uint_compare, 11);
+    hashmap_put(hm, (void*)2, (void*)1);
+    hashmap_put(hm, (void*)3, (void*)1);
+    CuAssertTrue(tc, NULL == hashmap_mph_build(hm));
+    hashmap_freeall(hm);
+}
@@ -0,0 +1,133 @@
+#include <stdbool.h>
+#include <assert.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "CuTest.h"
+
+#include "linked_list_hashmap.h"
+#include "hashmap_parallel.h"
+
+static unsigned long __uint_hash(
+    const void *e1
+    )
+{
+    const long i1 = (unsigned long)e1;
+
+    assert(i1 >= 0);
+    return i1;
+}
+
+static long __uint_compare(
+    const void *e1,
+    const void *e2
+    )
+{
+    const long i1 = (unsigned long)e1, i2 = (unsigned long)e2;
+
+    return i1 - i2;
+}
+
+static void __sum(
+    void *udata,
+    void *key __attribute__((__unused__)),
+    void *val
+    )
+{
+    __atomic_add_fetch((unsigned long*)udata, (unsigned long)val,
+                       __ATOMIC_RELAXED);
+}
+
+static void *__fold_sum(
+    void *udata __attribute__((__unused__)),
+    void *acc,
+    void *key __attribute__((__unused__)),
+    void *val
+    )
+{
+    return (void*)((unsigned long)acc + (unsigned long)val);
+}
+
+static void *__combine_sum(
+    void *udata __attribute__((__unused__)),
+    void *acc1,
+    void *acc2
+    )
+{
+    return (void*)((unsigned long)acc1 + (unsigned long)acc2);
+}
+
+void TestHashmapParallel_ForeachVisitsEverything(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm;
+    unsigned long ii, sum = 0;
+
+    hm = hashmap_new(__uint_hash, __uint_compare, 11);
+    for (ii = 1; ii <= 5000; ii++)
+        hashmap_put(hm, (void*)ii, (void*)ii);
+
+    hashmap_parallel_foreach(hm, __sum, &sum, 4);
+    CuAssertTrue(tc, 5000 * 5001 / 2 == sum);
+
+    hashmap_freeall(hm);
+}
+
+void TestHashmapParallel_ForeachOnEmptyMap(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm;
+    unsigned long sum = 0;
+
+    hm = hashmap_new(__uint_hash, __uint_compare, 3);
+    hashmap_parallel_foreach(hm, __sum, &sum, 8);
+    CuAssertTrue(tc, 0 == sum);
+
+    hashmap_freeall(hm);
+}
+
+void TestHashmapParallel_NoBuckets(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm;
+    unsigned long sum = 0;
+
+    hm = hashmap_new(__uint_hash, __uint_compare, 0);
+    hashmap_parallel_foreach(hm, __sum, &sum, 4);
+    CuAssertTrue(tc, 0 == sum);
+    CuAssertTrue(tc, 7 == (unsigned long)hashmap_parallel_reduce(
+                     hm, __fold_sum, __combine_sum, (void*)7, NULL, 4));
+
+    hashmap_freeall(hm);
+}
+
+void TestHashmapParallel_ReduceOverSkewedChains(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm;
+    unsigned long ii, expected = 0;
+
+    hm = hashmap_new(__uint_hash, __uint_compare, 1024);
+    hashmap_increase_capacity(hm, 2);
+
+    /* half of the items pile up in a handful of buckets */
+    for (ii = 1; ii <= 2000; ii++)
+    {
+        unsigned long key = ii % 2 ? ii : (ii % 4) + 2048 * ii;
+
+        hashmap_put(hm, (void*)key, (void*)ii);
+        expected += ii;
+    }
+
+    CuAssertTrue(tc, expected == (unsigned long)hashmap_parallel_reduce(
+                     hm, __fold_sum, __combine_sum, (void*)0, NULL, 4));
+    CuAssertTrue(tc, expected == (unsigned long)hashmap_parallel_reduce(
+                     hm, __fold_sum, __combine_sum, (void*)0, NULL, 1));
+
+    hashmap_freeall(hm);
+}
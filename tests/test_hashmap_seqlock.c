@@ -0,0 +1,207 @@
+#include <stdbool.h>
+#include <assert.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include "CuTest.h"
+
+#include "hashmap_seqlock.h"
+
+static unsigned long __uint_hash(
+    const void *e1
+    )
+{
+    const long i1 = (unsigned long)e1;
+
+    assert(i1 >= 0);
+    return i1;
+}
+
+static long __uint_compare(
+    const void *e1,
+    const void *e2
+    )
+{
+    const long i1 = (unsigned long)e1, i2 = (unsigned long)e2;
+
+    return i1 - i2;
+}
+
+void TestHashmapSeqlock_New(
+    CuTest * tc
+    )
+{
+    hashmap_seqlock_t *hm;
+
+    hm = hashmap_seqlock_new(__uint_hash, __uint_compare, 11, 4);
+
+    CuAssertTrue(tc, 0 == hashmap_seqlock_count(hm));
+
+    hashmap_seqlock_freeall(hm);
+}
+
+void TestHashmapSeqlock_PutAndGet(
+    CuTest * tc
+    )
+{
+    hashmap_seqlock_t *hm;
+
+    hm = hashmap_seqlock_new(__uint_hash, __uint_compare, 11, 4);
+    hashmap_seqlock_put(hm, (void*)50, (void*)92);
+    hashmap_seqlock_put(hm, (void*)51, (void*)93);
+
+    CuAssertTrue(tc, 2 == hashmap_seqlock_count(hm));
+    CuAssertTrue(tc, 92 == (unsigned long)hashmap_seqlock_get(hm, (void*)50));
+    CuAssertTrue(tc, 93 == (unsigned long)hashmap_seqlock_get(hm, (void*)51));
+    CuAssertTrue(tc, 0 == hashmap_seqlock_get(hm, (void*)52));
+
+    hashmap_seqlock_freeall(hm);
+}
+
+void TestHashmapSeqlock_Remove(
+    CuTest * tc
+    )
+{
+    hashmap_seqlock_t *hm;
+    unsigned long val;
+
+    hm = hashmap_seqlock_new(__uint_hash, __uint_compare, 11, 4);
+    hashmap_seqlock_put(hm, (void*)50, (void*)92);
+
+    val = (unsigned long)hashmap_seqlock_remove(hm, (void*)50);
+    CuAssertTrue(tc, val == 92);
+    CuAssertTrue(tc, 0 == hashmap_seqlock_count(hm));
+    CuAssertTrue(tc, 0 == hashmap_seqlock_contains_key(hm, (void*)50));
+
+    hashmap_seqlock_freeall(hm);
+}
+
+void TestHashmapSeqlock_GrowingKeepsItems(
+    CuTest * tc
+    )
+{
+    hashmap_seqlock_t *hm;
+    unsigned long ii;
+
+    hm = hashmap_seqlock_new(__uint_hash, __uint_compare, 4, 2);
+
+    for (ii = 1; ii <= 1000; ii++)
+        hashmap_seqlock_put(hm, (void*)ii, (void*)(ii + 1));
+
+    CuAssertTrue(tc, 1000 == hashmap_seqlock_count(hm));
+
+    for (ii = 1; ii <= 1000; ii++)
+        CuAssertTrue(tc, ii + 1 ==
+                     (unsigned long)hashmap_seqlock_get(hm, (void*)ii));
+
+    hashmap_seqlock_freeall(hm);
+}
+
+typedef struct
+{
+    hashmap_seqlock_t *hm;
+    int stop;
+    int bad;
+} __reader_t;
+
+static void *__reader(void *arg)
+{
+    __reader_t *r = arg;
+    unsigned long ii;
+
+    while (!__atomic_load_n(&r->stop, __ATOMIC_ACQUIRE))
+        for (ii = 1; ii <= 2000; ii++)
+        {
+            unsigned long val =
+                (unsigned long)hashmap_seqlock_get(r->hm, (void*)ii);
+
+            /* readers see either nothing or the value that was put */
+            if (val != 0 && val != ii + 1)
+                r->bad = 1;
+        }
+
+    return NULL;
+}
+
+void TestHashmapSeqlock_ReadersSeeConsistentValuesDuringWrites(
+    CuTest * tc
+    )
+{
+    pthread_t threads[2];
+    __reader_t r;
+    unsigned long ii;
+    int jj;
+
+    r.hm = hashmap_seqlock_new(__uint_hash, __uint_compare, 4, 4);
+    r.stop = 0;
+    r.bad = 0;
+
+    for (jj = 0; jj < 2; jj++)
+        pthread_create(&threads[jj], NULL, __reader, &r);
+
+    for (jj = 0; jj < 5; jj++)
+    {
+        for (ii = 1; ii <= 2000; ii++)
+            hashmap_seqlock_put(r.hm, (void*)ii, (void*)(ii + 1));
+        for (ii = 1; ii <= 2000; ii += 2)
+            hashmap_seqlock_remove(r.hm, (void*)ii);
+    }
+
+    __atomic_store_n(&r.stop, 1, __ATOMIC_RELEASE);
+    for (jj = 0; jj < 2; jj++)
+        pthread_join(threads[jj], NULL);
+
+    CuAssertTrue(tc, 0 == r.bad);
+    CuAssertTrue(tc, 1000 == hashmap_seqlock_count(r.hm));
+
+    hashmap_seqlock_freeall(r.hm);
+}
+
+void TestHashmapSeqlock_ConditionalUpdates(
+    CuTest * tc
+    )
+{
+    hashmap_seqlock_t *hm;
+
+    hm = hashmap_seqlock_new(__uint_hash, __uint_compare, 11, 4);
+
+    CuAssertTrue(tc, 0 == hashmap_seqlock_put_if_absent(hm, (void*)1, (void*)92));
+    CuAssertTrue(tc, 92 == (unsigned long)
+                 hashmap_seqlock_put_if_absent(hm, (void*)1, (void*)93));
+    CuAssertTrue(tc, 0 == hashmap_seqlock_replace_if(hm, (void*)1, (void*)93,
+                                                     (void*)94));
+    CuAssertTrue(tc, 1 == hashmap_seqlock_replace_if(hm, (void*)1, (void*)92,
+                                                     (void*)94));
+    CuAssertTrue(tc, 0 == hashmap_seqlock_remove_if(hm, (void*)1, (void*)92));
+    CuAssertTrue(tc, 1 == hashmap_seqlock_remove_if(hm, (void*)1, (void*)94));
+    CuAssertTrue(tc, 0 == hashmap_seqlock_count(hm));
+
+    hashmap_seqlock_freeall(hm);
+}
+
+void TestHashmapSeqlock_PutBatch(
+    CuTest * tc
+    )
+{
+    hashmap_seqlock_t *hm;
+    hashmap_entry_t entries[100];
+    unsigned long ii;
+
+    hm = hashmap_seqlock_new(__uint_hash, __uint_compare, 4, 4);
+
+    for (ii = 0; ii < 100; ii++)
+    {
+        entries[ii].key = (void*)(ii + 1);
+        entries[ii].val = (void*)(ii + 2);
+    }
+
+    hashmap_seqlock_put_batch(hm, entries, 100, NULL, NULL);
+    CuAssertTrue(tc, 100 == hashmap_seqlock_count(hm));
+    for (ii = 1; ii <= 100; ii++)
+        CuAssertTrue(tc, ii + 1 ==
+                     (unsigned long)hashmap_seqlock_get(hm, (void*)ii));
+
+    hashmap_seqlock_freeall(hm);
+}
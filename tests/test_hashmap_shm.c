@@ -0,0 +1,168 @@
+#include <stdbool.h>
+#include <assert.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "CuTest.h"
+
+#include "hashmap_shm.h"
+
+static int __put_str(
+    hashmap_shm_t * m,
+    const char *key,
+    const char *val
+    )
+{
+    return hashmap_shm_put(m, key, strlen(key), val, strlen(val) + 1);
+}
+
+static const char *__get_str(
+    hashmap_shm_t * m,
+    const char *key
+    )
+{
+    return hashmap_shm_get(m, key, strlen(key), NULL);
+}
+
+void TestHashmapShm_PutGetRemove(
+    CuTest * tc
+    )
+{
+    hashmap_shm_t *m;
+    size_t vlen;
+    char key[32], val[32];
+    int ii;
+
+    m = hashmap_shm_create(-1, 1 << 20, 64);
+    CuAssertPtrNotNull(tc, m);
+
+    for (ii = 0; ii < 500; ii++)
+    {
+        sprintf(key, "key%d", ii);
+        sprintf(val, "val%d", ii);
+        CuAssertTrue(tc, 0 == __put_str(m, key, val));
+    }
+    CuAssertTrue(tc, 500 == hashmap_shm_count(m));
+
+    for (ii = 0; ii < 500; ii++)
+    {
+        sprintf(key, "key%d", ii);
+        sprintf(val, "val%d", ii);
+        CuAssertStrEquals(tc, val, __get_str(m, key));
+    }
+
+    CuAssertTrue(tc, 0 == __put_str(m, "key7", "seven"));
+    CuAssertTrue(tc, 500 == hashmap_shm_count(m));
+    CuAssertStrEquals(tc, "seven", hashmap_shm_get(m, "key7", 4, &vlen));
+    CuAssertTrue(tc, 6 == vlen);
+
+    CuAssertTrue(tc, 1 == hashmap_shm_remove(m, "key8", 4));
+    CuAssertTrue(tc, 0 == hashmap_shm_remove(m, "key8", 4));
+    CuAssertTrue(tc, NULL == __get_str(m, "key8"));
+    CuAssertTrue(tc, 499 == hashmap_shm_count(m));
+
+    /* a prefix is a different key */
+    CuAssertTrue(tc, NULL == __get_str(m, "key"));
+
+    hashmap_shm_detach(m);
+}
+
+void TestHashmapShm_FullRegion(
+    CuTest * tc
+    )
+{
+    hashmap_shm_t *m;
+    char key[32];
+    int ii, ret = 0;
+
+    m = hashmap_shm_create(-1, 4096, 16);
+    for (ii = 0; ii < 1000 && 0 == ret; ii++)
+    {
+        sprintf(key, "key%d", ii);
+        ret = __put_str(m, key, "value");
+    }
+    CuAssertTrue(tc, -1 == ret);
+    CuAssertTrue(tc, ii - 1 == hashmap_shm_count(m));
+    CuAssertStrEquals(tc, "value", __get_str(m, "key0"));
+
+    CuAssertTrue(tc, NULL == hashmap_shm_create(-1, 64, 16));
+    hashmap_shm_detach(m);
+}
+
+void TestHashmapShm_ForkedReaderSeesWrites(
+    CuTest * tc
+    )
+{
+    hashmap_shm_t *m;
+    int fds[2], status;
+    pid_t pid;
+    char c;
+
+    m = hashmap_shm_create(-1, 1 << 16, 64);
+    __put_str(m, "before", "fork");
+    CuAssertTrue(tc, 0 == pipe(fds));
+
+    if (0 == (pid = fork()))
+    {
+        const char *v;
+
+        /* wait for the parent's second put */
+        if (1 != read(fds[0], &c, 1))
+            _exit(2);
+        v = __get_str(m, "after");
+        _exit(v && 0 == strcmp(v, "fork") &&
+              0 == strcmp(__get_str(m, "before"), "fork") &&
+              NULL == __get_str(m, "gone") ? 0 : 1);
+    }
+
+    __put_str(m, "gone", "soon");
+    __put_str(m, "after", "fork");
+    hashmap_shm_remove(m, "gone", 4);
+    CuAssertTrue(tc, 1 == write(fds[1], "x", 1));
+
+    CuAssertTrue(tc, pid == waitpid(pid, &status, 0));
+    CuAssertTrue(tc, WIFEXITED(status) && 0 == WEXITSTATUS(status));
+
+    close(fds[0]);
+    close(fds[1]);
+    hashmap_shm_detach(m);
+}
+
+void TestHashmapShm_AttachAtAnotherAddress(
+    CuTest * tc
+    )
+{
+    hashmap_shm_t *m, *r;
+    char path[] = "/tmp/test_hashmap_shmXXXXXX";
+    int fd;
+
+    fd = mkstemp(path);
+    unlink(path);
+
+    m = hashmap_shm_create(fd, 1 << 16, 32);
+    CuAssertPtrNotNull(tc, m);
+    __put_str(m, "alpha", "one");
+    __put_str(m, "beta", "two");
+
+    r = hashmap_shm_attach(fd);
+    CuAssertPtrNotNull(tc, r);
+    CuAssertTrue(tc, m->base != r->base);
+    CuAssertTrue(tc, 2 == hashmap_shm_count(r));
+    CuAssertStrEquals(tc, "one", __get_str(r, "alpha"));
+    CuAssertStrEquals(tc, "two", __get_str(r, "beta"));
+
+    /* later writes show up too */
+    __put_str(m, "gamma", "three");
+    CuAssertStrEquals(tc, "three", __get_str(r, "gamma"));
+
+    /* read only */
+    CuAssertTrue(tc, -1 == __put_str(r, "delta", "four"));
+    CuAssertTrue(tc, 0 == hashmap_shm_remove(r, "alpha", 5));
+
+    hashmap_shm_detach(r);
+    hashmap_shm_detach(m);
+    close(fd);
+}
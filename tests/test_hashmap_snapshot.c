@@ -0,0 +1,370 @@
+#include <stdbool.h>
+#include <assert.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "CuTest.h"
+
+#include "linked_list_hashmap.h"
+#include "hashmap_snapshot.h"
+
+static int __hash_calls = 0;
+
+static unsigned long __uint_hash(
+    const void *e1
+    )
+{
+    const long i1 = (unsigned long)e1;
+
+    assert(i1 >= 0);
+    __hash_calls++;
+    return i1;
+}
+
+static long __uint_compare(
+    const void *e1,
+    const void *e2
+    )
+{
+    const long i1 = (unsigned long)e1, i2 = (unsigned long)e2;
+
+    return i1 - i2;
+}
+
+static size_t __uint_encode(
+    void *udata __attribute__((__unused__)),
+    const void *obj,
+    void *buf,
+    size_t len
+    )
+{
+    if (sizeof(obj) <= len)
+        memcpy(buf, &obj, sizeof(obj));
+    return sizeof(obj);
+}
+
+static void *__uint_decode(
+    void *udata __attribute__((__unused__)),
+    const void *buf,
+    size_t len __attribute__((__unused__))
+    )
+{
+    void *obj;
+
+    memcpy(&obj, buf, sizeof(obj));
+    return obj;
+}
+
+static const hashmap_codec_t __codec = {
+    __uint_encode, __uint_decode, __uint_encode, __uint_decode, NULL
+};
+
+static void __tmpname(
+    char *path
+    )
+{
+    int fd;
+
+    strcpy(path, "/tmp/test_hashmap_snapshotXXXXXX");
+    fd = mkstemp(path);
+    close(fd);
+}
+
+void TestHashmapSnapshot_LoadRestoresEntries(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm, *hm2;
+    char path[64];
+    unsigned long ii;
+
+    __tmpname(path);
+    hm = hashmap_new(__uint_hash, __uint_compare, 11);
+    for (ii = 1; ii <= 500; ii++)
+        hashmap_put(hm, (void*)ii, (void*)(ii * 3));
+
+    CuAssertTrue(tc, 0 == hashmap_save(hm, path, &__codec));
+
+    hm2 = hashmap_load(path, __uint_hash, __uint_compare, &__codec);
+    CuAssertPtrNotNull(tc, hm2);
+    CuAssertTrue(tc, 500 == hashmap_count(hm2));
+    CuAssertTrue(tc, hashmap_size(hm) == hashmap_size(hm2));
+    for (ii = 1; ii <= 500; ii++)
+        CuAssertTrue(tc, ii * 3 == (unsigned long)hashmap_get(hm2, (void*)ii));
+
+    unlink(path);
+    hashmap_freeall(hm);
+    hashmap_freeall(hm2);
+}
+
+void TestHashmapSnapshot_LoadDoesNotRehash(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm, *hm2;
+    char path[64];
+    unsigned long ii;
+
+    __tmpname(path);
+    hm = hashmap_new(__uint_hash, __uint_compare, 11);
+    for (ii = 1; ii <= 100; ii++)
+        hashmap_put(hm, (void*)(ii * 7), (void*)ii);
+    CuAssertTrue(tc, 0 == hashmap_save(hm, path, &__codec));
+
+    __hash_calls = 0;
+    hm2 = hashmap_load(path, __uint_hash, __uint_compare, &__codec);
+    CuAssertPtrNotNull(tc, hm2);
+    CuAssertTrue(tc, 0 == __hash_calls);
+    CuAssertTrue(tc, 100 == hashmap_count(hm2));
+
+    unlink(path);
+    hashmap_freeall(hm);
+    hashmap_freeall(hm2);
+}
+
+void TestHashmapSnapshot_LoadKeepsChainOrder(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm, *hm2;
+    hashmap_iterator_t i1, i2;
+    char path[64];
+    unsigned long ii;
+
+    __tmpname(path);
+
+    /* keys collide in a small map */
+    hm = hashmap_new(__uint_hash, __uint_compare, 64);
+    for (ii = 0; ii < 20; ii++)
+        hashmap_put(hm, (void*)(ii * 64 + 1), (void*)(ii + 1));
+    CuAssertTrue(tc, 0 == hashmap_save(hm, path, &__codec));
+    hm2 = hashmap_load(path, __uint_hash, __uint_compare, &__codec);
+    CuAssertPtrNotNull(tc, hm2);
+
+    hashmap_iterator(hm, &i1);
+    hashmap_iterator(hm2, &i2);
+    while (hashmap_iterator_has_next(hm, &i1))
+    {
+        CuAssertTrue(tc, hashmap_iterator_has_next(hm2, &i2));
+        CuAssertTrue(tc, hashmap_iterator_next(hm, &i1) ==
+                     hashmap_iterator_next(hm2, &i2));
+    }
+    CuAssertTrue(tc, !hashmap_iterator_has_next(hm2, &i2));
+
+    unlink(path);
+    hashmap_freeall(hm);
+    hashmap_freeall(hm2);
+}
+
+void TestHashmapSnapshot_LoadEmptyMap(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm, *hm2;
+    char path[64];
+
+    __tmpname(path);
+    hm = hashmap_new(__uint_hash, __uint_compare, 11);
+    CuAssertTrue(tc, 0 == hashmap_save(hm, path, &__codec));
+    hm2 = hashmap_load(path, __uint_hash, __uint_compare, &__codec);
+    CuAssertPtrNotNull(tc, hm2);
+    CuAssertTrue(tc, 0 == hashmap_count(hm2));
+
+    unlink(path);
+    hashmap_freeall(hm);
+    hashmap_freeall(hm2);
+}
+
+void TestHashmapSnapshot_LoadRejectsBadFiles(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm;
+    char path[64];
+    unsigned long ii;
+    FILE *fp;
+
+    __tmpname(path);
+
+    fp = fopen(path, "wb");
+    fputs("not a snapshot file at all", fp);
+    fclose(fp);
+    CuAssertTrue(tc, NULL == hashmap_load(path, __uint_hash, __uint_compare,
+                                          &__codec));
+
+    /* truncated */
+    hm = hashmap_new(__uint_hash, __uint_compare, 11);
+    for (ii = 1; ii <= 50; ii++)
+        hashmap_put(hm, (void*)ii, (void*)ii);
+    CuAssertTrue(tc, 0 == hashmap_save(hm, path, &__codec));
+    CuAssertTrue(tc, 0 == truncate(path, 100));
+    CuAssertTrue(tc, NULL == hashmap_load(path, __uint_hash, __uint_compare,
+                                          &__codec));
+
+    unlink(path);
+    CuAssertTrue(tc, NULL == hashmap_load(path, __uint_hash, __uint_compare,
+                                          &__codec));
+    hashmap_freeall(hm);
+}
+
+void TestHashmapSnapshot_BackgroundSaveSeesMapAtFork(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm, *hm2;
+    char path[64];
+    unsigned long ii;
+    pid_t pid;
+
+    __tmpname(path);
+    hm = hashmap_new(__uint_hash, __uint_compare, 11);
+    for (ii = 1; ii <= 500; ii++)
+        hashmap_put(hm, (void*)ii, (void*)ii);
+
+    pid = hashmap_save_background(hm, path, &__codec);
+    CuAssertTrue(tc, 0 < pid);
+
+    /* keep changing the map while the child writes */
+    for (ii = 1; ii <= 250; ii++)
+        hashmap_remove(hm, (void*)ii);
+    for (ii = 1000; ii < 1100; ii++)
+        hashmap_put(hm, (void*)ii, (void*)ii);
+
+    CuAssertTrue(tc, 0 == hashmap_save_wait(pid, 1));
+
+    hm2 = hashmap_load(path, __uint_hash, __uint_compare, &__codec);
+    CuAssertPtrNotNull(tc, hm2);
+    CuAssertTrue(tc, 500 == hashmap_count(hm2));
+    for (ii = 1; ii <= 500; ii++)
+        CuAssertTrue(tc, ii == (unsigned long)hashmap_get(hm2, (void*)ii));
+    CuAssertTrue(tc, NULL == hashmap_get(hm2, (void*)1000));
+
+    unlink(path);
+    hashmap_freeall(hm);
+    hashmap_freeall(hm2);
+}
+
+void TestHashmapSnapshot_BackgroundSaveReportsFailure(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm;
+
+    hm = hashmap_new(__uint_hash, __uint_compare, 11);
+    hashmap_put(hm, (void*)1, (void*)1);
+    CuAssertTrue(tc, -1 == hashmap_save_background(hm,
+                                                   "/nonexistent/dir/snap",
+                                                   &__codec));
+    hashmap_freeall(hm);
+}
+
+static void __count_release(
+    void *udata __attribute__((__unused__)),
+    void *key __attribute__((__unused__)),
+    void *val __attribute__((__unused__))
+    )
+{
+    __hash_calls++;
+}
+
+void TestHashmapSnapshot_DeltaWritesOnlyDirtyBuckets(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm, *hm2;
+    char path[64], delta[64];
+    unsigned long ii;
+    struct stat st_full, st_delta;
+
+    __tmpname(path);
+    __tmpname(delta);
+    hm = hashmap_new(__uint_hash, __uint_compare, 1024);
+    for (ii = 1; ii <= 400; ii++)
+        hashmap_put(hm, (void*)ii, (void*)ii);
+    hashmap_track_dirty(hm, 1);
+    CuAssertTrue(tc, 0 == hashmap_save(hm, path, &__codec));
+
+    /* change a few buckets */
+    hashmap_put(hm, (void*)5, (void*)50);
+    hashmap_remove(hm, (void*)6);
+    hashmap_put(hm, (void*)900, (void*)900);
+    CuAssertTrue(tc, 0 == hashmap_save_delta(hm, delta, &__codec));
+    CuAssertTrue(tc, -1 == hashmap_next_dirty(hm, 0));
+
+    stat(path, &st_full);
+    stat(delta, &st_delta);
+    CuAssertTrue(tc, st_delta.st_size * 20 < st_full.st_size);
+
+    hm2 = hashmap_load(path, __uint_hash, __uint_compare, &__codec);
+    __hash_calls = 0;
+    CuAssertTrue(tc, 0 == hashmap_load_delta(hm2, delta, &__codec,
+                                             __count_release));
+    /* 5 and 6 were replaced; 900 is new */
+    CuAssertTrue(tc, 2 == __hash_calls);
+    CuAssertTrue(tc, 400 == hashmap_count(hm2));
+    CuAssertTrue(tc, 50 == (unsigned long)hashmap_get(hm2, (void*)5));
+    CuAssertTrue(tc, NULL == hashmap_get(hm2, (void*)6));
+    CuAssertTrue(tc, 900 == (unsigned long)hashmap_get(hm2, (void*)900));
+    for (ii = 7; ii <= 400; ii++)
+        CuAssertTrue(tc, ii == (unsigned long)hashmap_get(hm2, (void*)ii));
+
+    unlink(path);
+    unlink(delta);
+    hashmap_freeall(hm);
+    hashmap_freeall(hm2);
+}
+
+void TestHashmapSnapshot_DeltaAfterGrowing(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm, *hm2;
+    char path[64], delta[64];
+    unsigned long ii;
+
+    __tmpname(path);
+    __tmpname(delta);
+    hm = hashmap_new(__uint_hash, __uint_compare, 16);
+    for (ii = 1; ii <= 5; ii++)
+        hashmap_put(hm, (void*)ii, (void*)ii);
+    hashmap_track_dirty(hm, 1);
+    CuAssertTrue(tc, 0 == hashmap_save(hm, path, &__codec));
+
+    for (ii = 6; ii <= 100; ii++)
+        hashmap_put(hm, (void*)ii, (void*)ii);
+    CuAssertTrue(tc, 0 == hashmap_save_delta(hm, delta, &__codec));
+
+    hm2 = hashmap_load(path, __uint_hash, __uint_compare, &__codec);
+    CuAssertTrue(tc, 0 == hashmap_load_delta(hm2, delta, &__codec, NULL));
+    CuAssertTrue(tc, hashmap_size(hm) == hashmap_size(hm2));
+    CuAssertTrue(tc, 100 == hashmap_count(hm2));
+    for (ii = 1; ii <= 100; ii++)
+        CuAssertTrue(tc, ii == (unsigned long)hashmap_get(hm2, (void*)ii));
+
+    unlink(path);
+    unlink(delta);
+    hashmap_freeall(hm);
+    hashmap_freeall(hm2);
+}
+
+void TestHashmapSnapshot_DeltaNeedsTracking(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm;
+    char path[64];
+
+    __tmpname(path);
+    hm = hashmap_new(__uint_hash, __uint_compare, 16);
+    CuAssertTrue(tc, -1 == hashmap_save_delta(hm, path, &__codec));
+
+    /* a full snapshot is not a delta */
+    CuAssertTrue(tc, 0 == hashmap_save(hm, path, &__codec));
+    CuAssertTrue(tc, -1 == hashmap_load_delta(hm, path, &__codec, NULL));
+
+    unlink(path);
+    hashmap_freeall(hm);
+}
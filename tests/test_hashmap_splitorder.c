@@ -0,0 +1,257 @@
+#include <stdbool.h>
+#include <assert.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include "CuTest.h"
+
+#include "hashmap_splitorder.h"
+
+static unsigned long __uint_hash(
+    const void *e1
+    )
+{
+    const long i1 = (unsigned long)e1;
+
+    assert(i1 >= 0);
+    return i1;
+}
+
+static unsigned long __bad_hash(
+    const void *e1 __attribute__((__unused__))
+    )
+{
+    return 7;
+}
+
+static long __uint_compare(
+    const void *e1,
+    const void *e2
+    )
+{
+    const long i1 = (unsigned long)e1, i2 = (unsigned long)e2;
+
+    return i1 - i2;
+}
+
+void TestHashmapSplitorder_New(
+    CuTest * tc
+    )
+{
+    hashmap_splitorder_t *hm;
+
+    hm = hashmap_splitorder_new(__uint_hash, __uint_compare, 11);
+
+    CuAssertTrue(tc, 0 == hashmap_splitorder_count(hm));
+    CuAssertTrue(tc, 16 == hashmap_splitorder_size(hm));
+
+    hashmap_splitorder_freeall(hm);
+}
+
+void TestHashmapSplitorder_PutAndGet(
+    CuTest * tc
+    )
+{
+    hashmap_splitorder_t *hm;
+
+    hm = hashmap_splitorder_new(__uint_hash, __uint_compare, 4);
+    CuAssertTrue(tc, NULL == hashmap_splitorder_put(hm, (void*)50, (void*)92));
+    CuAssertTrue(tc, NULL == hashmap_splitorder_put(hm, (void*)51, (void*)93));
+
+    CuAssertTrue(tc, 2 == hashmap_splitorder_count(hm));
+    CuAssertTrue(tc, 92 == (unsigned long)hashmap_splitorder_get(hm, (void*)50));
+    CuAssertTrue(tc, 93 == (unsigned long)hashmap_splitorder_get(hm, (void*)51));
+    CuAssertTrue(tc, 0 == hashmap_splitorder_contains_key(hm, (void*)52));
+
+    hashmap_splitorder_freeall(hm);
+}
+
+void TestHashmapSplitorder_DoublePutReplacesValue(
+    CuTest * tc
+    )
+{
+    hashmap_splitorder_t *hm;
+    unsigned long val;
+
+    hm = hashmap_splitorder_new(__uint_hash, __uint_compare, 4);
+    hashmap_splitorder_put(hm, (void*)50, (void*)92);
+    val = (unsigned long)hashmap_splitorder_put(hm, (void*)50, (void*)23);
+
+    CuAssertTrue(tc, val == 92);
+    CuAssertTrue(tc, 23 == (unsigned long)hashmap_splitorder_get(hm, (void*)50));
+    CuAssertTrue(tc, 1 == hashmap_splitorder_count(hm));
+
+    hashmap_splitorder_freeall(hm);
+}
+
+void TestHashmapSplitorder_HandlesEqualHashes(
+    CuTest * tc
+    )
+{
+    hashmap_splitorder_t *hm;
+
+    hm = hashmap_splitorder_new(__bad_hash, __uint_compare, 4);
+    hashmap_splitorder_put(hm, (void*)1, (void*)92);
+    hashmap_splitorder_put(hm, (void*)2, (void*)93);
+    hashmap_splitorder_put(hm, (void*)3, (void*)94);
+
+    CuAssertTrue(tc, 93 == (unsigned long)hashmap_splitorder_remove(hm, (void*)2));
+    CuAssertTrue(tc, 92 == (unsigned long)hashmap_splitorder_get(hm, (void*)1));
+    CuAssertTrue(tc, 94 == (unsigned long)hashmap_splitorder_get(hm, (void*)3));
+    CuAssertTrue(tc, 2 == hashmap_splitorder_count(hm));
+
+    hashmap_splitorder_freeall(hm);
+}
+
+void TestHashmapSplitorder_GrowsWithoutLosingItems(
+    CuTest * tc
+    )
+{
+    hashmap_splitorder_t *hm;
+    unsigned long ii;
+
+    hm = hashmap_splitorder_new(__uint_hash, __uint_compare, 1);
+
+    for (ii = 1; ii <= 1000; ii++)
+        hashmap_splitorder_put(hm, (void*)ii, (void*)(ii + 1));
+
+    CuAssertTrue(tc, 1000 == hashmap_splitorder_count(hm));
+    CuAssertTrue(tc, 512 <= hashmap_splitorder_size(hm));
+
+    for (ii = 1; ii <= 1000; ii++)
+        CuAssertTrue(tc, ii + 1 ==
+                     (unsigned long)hashmap_splitorder_get(hm, (void*)ii));
+
+    hashmap_splitorder_freeall(hm);
+}
+
+typedef struct
+{
+    hashmap_splitorder_t *hm;
+    unsigned long from;
+} __writer_t;
+
+static void *__writer(void *arg)
+{
+    __writer_t *w = arg;
+    unsigned long ii;
+
+    for (ii = w->from; ii < w->from + 2000; ii++)
+        hashmap_splitorder_put(w->hm, (void*)ii, (void*)(ii + 1));
+
+    /* remove every other item again */
+    for (ii = w->from; ii < w->from + 2000; ii += 2)
+        hashmap_splitorder_remove(w->hm, (void*)ii);
+
+    return NULL;
+}
+
+void TestHashmapSplitorder_ConcurrentWriters(
+    CuTest * tc
+    )
+{
+    pthread_t threads[4];
+    __writer_t w[4];
+    hashmap_splitorder_t *hm;
+    unsigned long ii;
+    int jj;
+
+    hm = hashmap_splitorder_new(__uint_hash, __uint_compare, 2);
+
+    for (jj = 0; jj < 4; jj++)
+    {
+        w[jj].hm = hm;
+        w[jj].from = 1 + jj * 2000;
+        pthread_create(&threads[jj], NULL, __writer, &w[jj]);
+    }
+
+    for (jj = 0; jj < 4; jj++)
+        pthread_join(threads[jj], NULL);
+
+    CuAssertTrue(tc, 4000 == hashmap_splitorder_count(hm));
+
+    for (ii = 1; ii <= 8000; ii++)
+    {
+        unsigned long val = (unsigned long)hashmap_splitorder_get(hm, (void*)ii);
+
+        if (ii % 2)
+            CuAssertTrue(tc, 0 == val);
+        else
+            CuAssertTrue(tc, ii + 1 == val);
+    }
+
+    hashmap_splitorder_freeall(hm);
+}
+
+void TestHashmapSplitorder_ConditionalUpdates(
+    CuTest * tc
+    )
+{
+    hashmap_splitorder_t *hm;
+
+    hm = hashmap_splitorder_new(__uint_hash, __uint_compare, 4);
+
+    CuAssertTrue(tc, 0 == hashmap_splitorder_put_if_absent(hm, (void*)1,
+                                                           (void*)92));
+    CuAssertTrue(tc, 92 == (unsigned long)
+                 hashmap_splitorder_put_if_absent(hm, (void*)1, (void*)93));
+    CuAssertTrue(tc, 0 == hashmap_splitorder_replace_if(hm, (void*)1,
+                                                        (void*)93, (void*)94));
+    CuAssertTrue(tc, 1 == hashmap_splitorder_replace_if(hm, (void*)1,
+                                                        (void*)92, (void*)94));
+    CuAssertTrue(tc, 0 == hashmap_splitorder_remove_if(hm, (void*)1,
+                                                       (void*)92));
+    CuAssertTrue(tc, 1 == hashmap_splitorder_remove_if(hm, (void*)1,
+                                                       (void*)94));
+    CuAssertTrue(tc, 0 == hashmap_splitorder_count(hm));
+    CuAssertTrue(tc, 0 == hashmap_splitorder_get(hm, (void*)1));
+
+    /* removed keys can come back */
+    CuAssertTrue(tc, 0 == hashmap_splitorder_put_if_absent(hm, (void*)1,
+                                                           (void*)95));
+    CuAssertTrue(tc, 95 == (unsigned long)hashmap_splitorder_get(hm, (void*)1));
+
+    hashmap_splitorder_freeall(hm);
+}
+
+static void *__incrementer(void *arg)
+{
+    hashmap_splitorder_t *hm = arg;
+    int ii;
+
+    for (ii = 0; ii < 1000; ii++)
+    {
+        void *val;
+
+        /* counters are stored off by one, as values can't be NULL */
+        do
+            val = hashmap_splitorder_get(hm, (void*)1);
+        while (!hashmap_splitorder_replace_if(hm, (void*)1, val,
+                                              (void*)((unsigned long)val + 1)));
+    }
+
+    return NULL;
+}
+
+void TestHashmapSplitorder_ReplaceIfIsAtomic(
+    CuTest * tc
+    )
+{
+    pthread_t threads[4];
+    hashmap_splitorder_t *hm;
+    int jj;
+
+    hm = hashmap_splitorder_new(__uint_hash, __uint_compare, 4);
+    hashmap_splitorder_put(hm, (void*)1, (void*)1);
+
+    for (jj = 0; jj < 4; jj++)
+        pthread_create(&threads[jj], NULL, __incrementer, hm);
+    for (jj = 0; jj < 4; jj++)
+        pthread_join(threads[jj], NULL);
+
+    CuAssertTrue(tc, 4001 == (unsigned long)hashmap_splitorder_get(hm, (void*)1));
+
+    hashmap_splitorder_freeall(hm);
+}
@@ -0,0 +1,111 @@
+#include <stdbool.h>
+#include <assert.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "CuTest.h"
+
+#include "hashmap_unrolled.h"
+
+static int __compare_calls = 0;
+
+static unsigned long __uint_hash(
+    const void *e1
+    )
+{
+    const long i1 = (unsigned long)e1;
+
+    assert(i1 >= 0);
+    return i1;
+}
+
+static long __uint_compare(
+    const void *e1,
+    const void *e2
+    )
+{
+    const long i1 = (unsigned long)e1, i2 = (unsigned long)e2;
+
+    __compare_calls++;
+    return i1 - i2;
+}
+
+void TestHashmapUnrolled_New(
+    CuTest * tc
+    )
+{
+    hashmap_unrolled_t *hm;
+
+    hm = hashmap_unrolled_new(__uint_hash, __uint_compare, 100);
+    CuAssertTrue(tc, 0 == hashmap_unrolled_count(hm));
+    CuAssertTrue(tc, 100 <= hashmap_unrolled_size(hm) * 2);
+    CuAssertTrue(tc, NULL == hashmap_unrolled_get(hm, (void*)1));
+    hashmap_unrolled_freeall(hm);
+}
+
+void TestHashmapUnrolled_PutGetRemove(
+    CuTest * tc
+    )
+{
+    hashmap_unrolled_t *hm;
+    unsigned long ii;
+
+    hm = hashmap_unrolled_new(__uint_hash, __uint_compare, 4);
+    for (ii = 1; ii <= 5000; ii++)
+        CuAssertTrue(tc, NULL == hashmap_unrolled_put(hm, (void*)ii,
+                                                      (void*)(ii + 1)));
+    CuAssertTrue(tc, 5000 == hashmap_unrolled_count(hm));
+    for (ii = 1; ii <= 5000; ii++)
+        CuAssertTrue(tc, ii + 1 ==
+                     (unsigned long)hashmap_unrolled_get(hm, (void*)ii));
+
+    CuAssertTrue(tc, 6 == (unsigned long)hashmap_unrolled_put(hm, (void*)5,
+                                                              (void*)9));
+    CuAssertTrue(tc, 9 == (unsigned long)hashmap_unrolled_get(hm, (void*)5));
+
+    for (ii = 1; ii <= 5000; ii += 2)
+        CuAssertTrue(tc, NULL != hashmap_unrolled_remove(hm, (void*)ii));
+    CuAssertTrue(tc, NULL == hashmap_unrolled_remove(hm, (void*)1));
+    CuAssertTrue(tc, 2500 == hashmap_unrolled_count(hm));
+    for (ii = 1; ii <= 5000; ii++)
+        CuAssertTrue(tc, (ii % 2 == 0) ==
+                     hashmap_unrolled_contains_key(hm, (void*)ii));
+
+    hashmap_unrolled_freeall(hm);
+}
+
+void TestHashmapUnrolled_LongChains(
+    CuTest * tc
+    )
+{
+    hashmap_unrolled_t *hm;
+    unsigned long ii;
+
+    /* a single bucket until the map grows */
+    hm = hashmap_unrolled_new(__uint_hash, __uint_compare, 1);
+    CuAssertTrue(tc, 1 == hashmap_unrolled_size(hm));
+    for (ii = 1; ii <= 2; ii++)
+        hashmap_unrolled_put(hm, (void*)ii, (void*)ii);
+
+    /* fingerprints keep most non-matching keys from being compared */
+    __compare_calls = 0;
+    CuAssertTrue(tc, NULL == hashmap_unrolled_get(hm, (void*)100));
+    CuAssertTrue(tc, __compare_calls <= 2);
+
+    /* empty the chain from the front, so entries move around */
+    for (ii = 1; ii <= 2; ii++)
+        CuAssertTrue(tc, ii ==
+                     (unsigned long)hashmap_unrolled_remove(hm, (void*)ii));
+    CuAssertTrue(tc, 0 == hashmap_unrolled_count(hm));
+
+    for (ii = 1; ii <= 1000; ii++)
+        hashmap_unrolled_put(hm, (void*)(ii << 20), (void*)ii);
+    for (ii = 1; ii <= 1000; ii += 3)
+        hashmap_unrolled_remove(hm, (void*)(ii << 20));
+    for (ii = 1; ii <= 1000; ii++)
+        CuAssertTrue(tc, (ii % 3 == 1 ? 0 : ii) ==
+                     (unsigned long)hashmap_unrolled_get(hm, (void*)(ii << 20)));
+
+    hashmap_unrolled_freeall(hm);
+}
@@ -0,0 +1,304 @@
+#include <stdbool.h>
+#include <assert.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "CuTest.h"
+
+#include "linked_list_hashmap.h"
+#include "hashmap_snapshot.h"
+#include "hashmap_wal.h"
+
+static int __hash_calls = 0;
+
+static unsigned long __uint_hash(
+    const void *e1
+    )
+{
+    const long i1 = (unsigned long)e1;
+
+    assert(i1 >= 0);
+    __hash_calls++;
+    return i1;
+}
+
+static long __uint_compare(
+    const void *e1,
+    const void *e2
+    )
+{
+    const long i1 = (unsigned long)e1, i2 = (unsigned long)e2;
+
+    return i1 - i2;
+}
+
+static size_t __uint_encode(
+    void *udata __attribute__((__unused__)),
+    const void *obj,
+    void *buf,
+    size_t len
+    )
+{
+    if (sizeof(obj) <= len)
+        memcpy(buf, &obj, sizeof(obj));
+    return sizeof(obj);
+}
+
+static void *__uint_decode(
+    void *udata __attribute__((__unused__)),
+    const void *buf,
+    size_t len __attribute__((__unused__))
+    )
+{
+    void *obj;
+
+    memcpy(&obj, buf, sizeof(obj));
+    return obj;
+}
+
+static const hashmap_codec_t __codec = {
+    __uint_encode, __uint_decode, __uint_encode, __uint_decode, NULL
+};
+
+static void __tmpname(
+    char *path
+    )
+{
+    int fd;
+
+    strcpy(path, "/tmp/test_hashmap_walXXXXXX");
+    fd = mkstemp(path);
+    close(fd);
+}
+
+static hashmap_wal_t *__open(
+    const char *path,
+    const char *snapshot_path
+    )
+{
+    return hashmap_wal_open(path, snapshot_path, __uint_hash, __uint_compare,
+                            &__codec, NULL, 16);
+}
+
+void TestHashmapWal_ReopenReplaysLog(
+    CuTest * tc
+    )
+{
+    hashmap_wal_t *w;
+    hashmap_t *hm;
+    char path[64];
+    unsigned long ii;
+
+    __tmpname(path);
+    w = __open(path, NULL);
+    CuAssertPtrNotNull(tc, w);
+    for (ii = 1; ii <= 300; ii++)
+        hashmap_wal_put(w, (void*)ii, (void*)(ii * 2));
+    for (ii = 1; ii <= 100; ii++)
+        CuAssertTrue(tc, ii * 2 == (unsigned long)hashmap_wal_remove(w, (void*)ii));
+    hashmap_wal_put(w, (void*)200, (void*)7);
+    hm = w->map;
+    CuAssertTrue(tc, 0 == hashmap_wal_close(w));
+    hashmap_freeall(hm);
+
+    w = __open(path, NULL);
+    CuAssertPtrNotNull(tc, w);
+    CuAssertTrue(tc, 200 == hashmap_count(w->map));
+    CuAssertTrue(tc, NULL == hashmap_get(w->map, (void*)50));
+    CuAssertTrue(tc, 7 == (unsigned long)hashmap_get(w->map, (void*)200));
+    CuAssertTrue(tc, 600 == (unsigned long)hashmap_get(w->map, (void*)300));
+
+    hm = w->map;
+    hashmap_wal_close(w);
+    hashmap_freeall(hm);
+    unlink(path);
+}
+
+void TestHashmapWal_ReplayDoesNotRehash(
+    CuTest * tc
+    )
+{
+    hashmap_wal_t *w;
+    hashmap_t *hm;
+    char path[64];
+    unsigned long ii;
+
+    __tmpname(path);
+    w = __open(path, NULL);
+    for (ii = 1; ii <= 200; ii++)
+        hashmap_wal_put(w, (void*)ii, (void*)ii);
+    hm = w->map;
+    hashmap_wal_close(w);
+    hashmap_freeall(hm);
+
+    __hash_calls = 0;
+    w = __open(path, NULL);
+    CuAssertTrue(tc, 0 == __hash_calls);
+    CuAssertTrue(tc, 200 == hashmap_count(w->map));
+
+    hm = w->map;
+    hashmap_wal_close(w);
+    hashmap_freeall(hm);
+    unlink(path);
+}
+
+void TestHashmapWal_CheckpointThenReplaySuffix(
+    CuTest * tc
+    )
+{
+    hashmap_wal_t *w;
+    hashmap_t *hm;
+    char path[64], snap[64];
+    unsigned long ii;
+
+    __tmpname(path);
+    __tmpname(snap);
+    unlink(snap);
+
+    w = __open(path, snap);
+    for (ii = 1; ii <= 100; ii++)
+        hashmap_wal_put(w, (void*)ii, (void*)ii);
+    CuAssertTrue(tc, 0 == hashmap_wal_checkpoint(w, snap));
+    for (ii = 101; ii <= 150; ii++)
+        hashmap_wal_put(w, (void*)ii, (void*)ii);
+    hashmap_wal_remove(w, (void*)1);
+    hm = w->map;
+    hashmap_wal_close(w);
+    hashmap_freeall(hm);
+
+    w = __open(path, snap);
+    CuAssertPtrNotNull(tc, w);
+    CuAssertTrue(tc, 149 == hashmap_count(w->map));
+    CuAssertTrue(tc, NULL == hashmap_get(w->map, (void*)1));
+    for (ii = 2; ii <= 150; ii++)
+        CuAssertTrue(tc, ii == (unsigned long)hashmap_get(w->map, (void*)ii));
+
+    hm = w->map;
+    hashmap_wal_close(w);
+    hashmap_freeall(hm);
+    unlink(path);
+    unlink(snap);
+}
+
+void TestHashmapWal_TornTailIsDropped(
+    CuTest * tc
+    )
+{
+    hashmap_wal_t *w;
+    hashmap_t *hm;
+    char path[64];
+    unsigned long ii;
+    FILE *fp;
+
+    __tmpname(path);
+    w = __open(path, NULL);
+    for (ii = 1; ii <= 10; ii++)
+        hashmap_wal_put(w, (void*)ii, (void*)ii);
+    hm = w->map;
+    hashmap_wal_close(w);
+    hashmap_freeall(hm);
+
+    /* half a record */
+    fp = fopen(path, "ab");
+    fwrite("\x01\x02\x03\x04\x05\x06\x07", 1, 7, fp);
+    fclose(fp);
+
+    w = __open(path, NULL);
+    CuAssertPtrNotNull(tc, w);
+    CuAssertTrue(tc, 10 == hashmap_count(w->map));
+
+    /* records after the cut are still found */
+    hashmap_wal_put(w, (void*)11, (void*)11);
+    hm = w->map;
+    hashmap_wal_close(w);
+    hashmap_freeall(hm);
+
+    w = __open(path, NULL);
+    CuAssertTrue(tc, 11 == hashmap_count(w->map));
+    CuAssertTrue(tc, 11 == (unsigned long)hashmap_get(w->map, (void*)11));
+
+    hm = w->map;
+    hashmap_wal_close(w);
+    hashmap_freeall(hm);
+    unlink(path);
+}
+
+void TestHashmapWal_FailedGroupCommitIsReported(
+    CuTest * tc
+    )
+{
+    hashmap_wal_t *w;
+    hashmap_t *hm;
+    char path[64];
+    int fd;
+
+    __tmpname(path);
+    w = hashmap_wal_open(path, NULL, __uint_hash, __uint_compare, &__codec,
+                         NULL, 1);
+
+    /* every put commits, and the log can't be written */
+    fd = open(path, O_RDONLY);
+    dup2(fd, w->fd);
+    close(fd);
+    hashmap_wal_put(w, (void*)1, (void*)1);
+    hashmap_wal_put(w, (void*)2, (void*)2);
+    CuAssertTrue(tc, -1 == hashmap_wal_sync(w));
+
+    /* the records are kept, and written once the log is writable again */
+    fd = open(path, O_WRONLY | O_APPEND);
+    dup2(fd, w->fd);
+    close(fd);
+    CuAssertTrue(tc, 0 == hashmap_wal_sync(w));
+    hm = w->map;
+    CuAssertTrue(tc, 0 == hashmap_wal_close(w));
+    hashmap_freeall(hm);
+
+    w = __open(path, NULL);
+    CuAssertTrue(tc, 2 == hashmap_count(w->map));
+
+    hm = w->map;
+    hashmap_wal_close(w);
+    hashmap_freeall(hm);
+    unlink(path);
+}
+
+void TestHashmapWal_RecoveryFromSnapshotDoesNotRehash(
+    CuTest * tc
+    )
+{
+    hashmap_wal_t *w;
+    hashmap_t *hm;
+    char path[64], snap[64];
+    unsigned long ii;
+
+    __tmpname(path);
+    __tmpname(snap);
+    unlink(snap);
+
+    /* the log holds far more than the snapshot's buckets can take */
+    w = __open(path, snap);
+    for (ii = 1; ii <= 50; ii++)
+        hashmap_wal_put(w, (void*)ii, (void*)ii);
+    CuAssertTrue(tc, 0 == hashmap_wal_checkpoint(w, snap));
+    for (ii = 51; ii <= 1000; ii++)
+        hashmap_wal_put(w, (void*)ii, (void*)ii);
+    hm = w->map;
+    hashmap_wal_close(w);
+    hashmap_freeall(hm);
+
+    __hash_calls = 0;
+    w = __open(path, snap);
+    CuAssertTrue(tc, 0 == __hash_calls);
+    CuAssertTrue(tc, 1000 == hashmap_count(w->map));
+    for (ii = 1; ii <= 1000; ii++)
+        CuAssertTrue(tc, ii == (unsigned long)hashmap_get(w->map, (void*)ii));
+
+    hm = w->map;
+    hashmap_wal_close(w);
+    hashmap_freeall(hm);
+    unlink(path);
+    unlink(snap);
+}
@@ -0,0 +1,150 @@
+#include <stdbool.h>
+#include <assert.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include "CuTest.h"
+
+#include "hashmap_seqlock.h"
+#include "hashmap_wbuf.h"
+
+static unsigned long __uint_hash(
+    const void *e1
+    )
+{
+    const long i1 = (unsigned long)e1;
+
+    assert(i1 >= 0);
+    return i1;
+}
+
+static long __uint_compare(
+    const void *e1,
+    const void *e2
+    )
+{
+    const long i1 = (unsigned long)e1, i2 = (unsigned long)e2;
+
+    return i1 - i2;
+}
+
+static void *__add(
+    void *udata __attribute__((__unused__)),
+    void *val_old,
+    void *val_new
+    )
+{
+    return (void*)((unsigned long)val_old + (unsigned long)val_new);
+}
+
+void TestHashmapWbuf_PutIsBufferedUntilFlush(
+    CuTest * tc
+    )
+{
+    hashmap_seqlock_t *hm;
+    hashmap_wbuf_t *b;
+
+    hm = hashmap_seqlock_new(__uint_hash, __uint_compare, 11, 4);
+    b = hashmap_wbuf_new(hm, 10, NULL, NULL);
+
+    hashmap_wbuf_put(b, (void*)50, (void*)92);
+    CuAssertTrue(tc, 1 == hashmap_wbuf_count(b));
+    CuAssertTrue(tc, 0 == hashmap_seqlock_count(hm));
+    CuAssertTrue(tc, 92 == (unsigned long)hashmap_wbuf_get(b, (void*)50));
+
+    CuAssertTrue(tc, 1 == hashmap_wbuf_flush(b));
+    CuAssertTrue(tc, 0 == hashmap_wbuf_count(b));
+    CuAssertTrue(tc, 92 == (unsigned long)hashmap_seqlock_get(hm, (void*)50));
+
+    hashmap_wbuf_freeall(b);
+    hashmap_seqlock_freeall(hm);
+}
+
+void TestHashmapWbuf_FlushesAtThreshold(
+    CuTest * tc
+    )
+{
+    hashmap_seqlock_t *hm;
+    hashmap_wbuf_t *b;
+    unsigned long ii;
+
+    hm = hashmap_seqlock_new(__uint_hash, __uint_compare, 11, 4);
+    b = hashmap_wbuf_new(hm, 4, NULL, NULL);
+
+    for (ii = 1; ii <= 3; ii++)
+        hashmap_wbuf_put(b, (void*)ii, (void*)(ii + 1));
+    CuAssertTrue(tc, 0 == hashmap_seqlock_count(hm));
+
+    hashmap_wbuf_put(b, (void*)4, (void*)5);
+    CuAssertTrue(tc, 4 == hashmap_seqlock_count(hm));
+    CuAssertTrue(tc, 0 == hashmap_wbuf_count(b));
+
+    hashmap_wbuf_freeall(b);
+    hashmap_seqlock_freeall(hm);
+}
+
+void TestHashmapWbuf_LocalValueShadowsShared(
+    CuTest * tc
+    )
+{
+    hashmap_seqlock_t *hm;
+    hashmap_wbuf_t *b;
+
+    hm = hashmap_seqlock_new(__uint_hash, __uint_compare, 11, 4);
+    b = hashmap_wbuf_new(hm, 10, NULL, NULL);
+
+    hashmap_seqlock_put(hm, (void*)50, (void*)92);
+    CuAssertTrue(tc, 92 == (unsigned long)hashmap_wbuf_get(b, (void*)50));
+    hashmap_wbuf_put(b, (void*)50, (void*)93);
+    CuAssertTrue(tc, 93 == (unsigned long)hashmap_wbuf_get(b, (void*)50));
+
+    /* freeing flushes */
+    hashmap_wbuf_freeall(b);
+    CuAssertTrue(tc, 93 == (unsigned long)hashmap_seqlock_get(hm, (void*)50));
+
+    hashmap_seqlock_freeall(hm);
+}
+
+typedef struct
+{
+    hashmap_seqlock_t *hm;
+} __counter_t;
+
+static void *__counter(void *arg)
+{
+    __counter_t *c = arg;
+    hashmap_wbuf_t *b = hashmap_wbuf_new(c->hm, 16, __add, NULL);
+    unsigned long ii;
+
+    for (ii = 0; ii < 10000; ii++)
+        hashmap_wbuf_put(b, (void*)(1 + ii % 100), (void*)1);
+
+    hashmap_wbuf_freeall(b);
+    return NULL;
+}
+
+void TestHashmapWbuf_MergedCountersAddUpAcrossThreads(
+    CuTest * tc
+    )
+{
+    pthread_t threads[4];
+    __counter_t c;
+    unsigned long ii;
+    int jj;
+
+    c.hm = hashmap_seqlock_new(__uint_hash, __uint_compare, 11, 8);
+
+    for (jj = 0; jj < 4; jj++)
+        pthread_create(&threads[jj], NULL, __counter, &c);
+    for (jj = 0; jj < 4; jj++)
+        pthread_join(threads[jj], NULL);
+
+    CuAssertTrue(tc, 100 == hashmap_seqlock_count(c.hm));
+    for (ii = 1; ii <= 100; ii++)
+        CuAssertTrue(tc, 400 ==
+                     (unsigned long)hashmap_seqlock_get(c.hm, (void*)ii));
+
+    hashmap_seqlock_freeall(c.hm);
+}
@@ -482,3 +482,733 @@ void TestHashmaplinked_IterateAndRemoveDoesntBreakIteration(
     hashmap_freeall(hm2);
 }
 
+void TestHashmaplinked_PutIfAbsentDoesNotReplace(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm;
+    unsigned long val;
+
+    hm = hashmap_new(__uint_hash, __uint_compare, 4);
+    val = (unsigned long)hashmap_put_if_absent(hm, (void*)1, (void*)92);
+    CuAssertTrue(tc, 0 == val);
+    /* collides with 1 */
+    val = (unsigned long)hashmap_put_if_absent(hm, (void*)5, (void*)93);
+    CuAssertTrue(tc, 0 == val);
+
+    val = (unsigned long)hashmap_put_if_absent(hm, (void*)5, (void*)94);
+    CuAssertTrue(tc, 93 == val);
+    CuAssertTrue(tc, 93 == (unsigned long)hashmap_get(hm, (void*)5));
+    CuAssertTrue(tc, 2 == hashmap_count(hm));
+
+    hashmap_freeall(hm);
+}
+
+void TestHashmaplinked_ReplaceIfOnlyReplacesExpected(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm;
+
+    hm = hashmap_new(__uint_hash, __uint_compare, 4);
+    hashmap_put(hm, (void*)1, (void*)92);
+    hashmap_put(hm, (void*)5, (void*)93);
+
+    CuAssertTrue(tc, 0 == hashmap_replace_if(hm, (void*)5, (void*)92,
+                                             (void*)94));
+    CuAssertTrue(tc, 93 == (unsigned long)hashmap_get(hm, (void*)5));
+    CuAssertTrue(tc, 1 == hashmap_replace_if(hm, (void*)5, (void*)93,
+                                             (void*)94));
+    CuAssertTrue(tc, 94 == (unsigned long)hashmap_get(hm, (void*)5));
+    CuAssertTrue(tc, 0 == hashmap_replace_if(hm, (void*)9, (void*)93,
+                                             (void*)94));
+    CuAssertTrue(tc, 2 == hashmap_count(hm));
+
+    hashmap_freeall(hm);
+}
+
+void TestHashmaplinked_RemoveIfOnlyRemovesExpected(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm;
+
+    hm = hashmap_new(__uint_hash, __uint_compare, 4);
+    hashmap_put(hm, (void*)1, (void*)92);
+    hashmap_put(hm, (void*)5, (void*)93);
+
+    CuAssertTrue(tc, 0 == hashmap_remove_if(hm, (void*)1, (void*)93));
+    CuAssertTrue(tc, 2 == hashmap_count(hm));
+    CuAssertTrue(tc, 1 == hashmap_remove_if(hm, (void*)1, (void*)92));
+    CuAssertTrue(tc, 1 == hashmap_count(hm));
+    CuAssertTrue(tc, 0 == hashmap_get(hm, (void*)1));
+    CuAssertTrue(tc, 93 == (unsigned long)hashmap_get(hm, (void*)5));
+
+    hashmap_freeall(hm);
+}
+
+static void __scan_remove(
+    void *udata,
+    void *key,
+    void *val __attribute__((__unused__))
+    )
+{
+    hashmap_remove(udata, key);
+}
+
+void TestHashmaplinked_ScanVisitsEverything(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm, *hm2;
+    unsigned long ii, cursor = 0;
+
+    hm = hashmap_new(__uint_hash, __uint_compare, 11);
+    hm2 = hashmap_new(__uint_hash, __uint_compare, 11);
+
+    for (ii = 1; ii <= 100; ii++)
+    {
+        hashmap_put(hm, (void*)ii, (void*)ii);
+        hashmap_put(hm2, (void*)ii, (void*)ii);
+    }
+
+    do
+        cursor = hashmap_scan(hm, cursor, __scan_remove, hm2);
+    while (cursor);
+
+    CuAssertTrue(tc, 0 == hashmap_count(hm2));
+
+    hashmap_freeall(hm);
+    hashmap_freeall(hm2);
+}
+
+void TestHashmaplinked_ScanSurvivesCapacityIncrease(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm, *hm2;
+    unsigned long ii, cursor = 0;
+    int calls = 0;
+
+    hm = hashmap_new(__uint_hash, __uint_compare, 12);
+    hm2 = hashmap_new(__uint_hash, __uint_compare, 11);
+
+    for (ii = 1; ii <= 5; ii++)
+    {
+        hashmap_put(hm, (void*)ii, (void*)ii);
+        hashmap_put(hm2, (void*)ii, (void*)ii);
+    }
+
+    do
+    {
+        cursor = hashmap_scan(hm, cursor, __scan_remove, hm2);
+
+        /* grow the map while we scan it */
+        if (++calls <= 10)
+            for (ii = 0; ii < 10; ii++)
+                hashmap_put(hm, (void*)(1000 + calls * 10 + ii), (void*)1);
+        CuAssertTrue(tc, calls < 10000);
+    }
+    while (cursor);
+
+    CuAssertTrue(tc, 12 < hashmap_size(hm));
+    CuAssertTrue(tc, 0 == hashmap_count(hm2));
+
+    hashmap_freeall(hm);
+    hashmap_freeall(hm2);
+}
+
+void TestHashmaplinked_ScanSurvivesPowerOfTwoGrowth(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm, *hm2;
+    unsigned long ii, cursor = 0;
+    int calls = 0;
+
+    hm = hashmap_new(__uint_hash, __uint_compare, 12);
+    hm2 = hashmap_new(__uint_hash, __uint_compare, 11);
+
+    for (ii = 1; ii <= 5; ii++)
+    {
+        hashmap_put(hm, (void*)ii, (void*)ii);
+        hashmap_put(hm2, (void*)ii, (void*)ii);
+    }
+
+    do
+    {
+        cursor = hashmap_scan(hm, cursor, __scan_remove, hm2);
+
+        /* grow by 2, then by 4, part way through */
+        if (++calls == 2)
+            hashmap_increase_capacity(hm, 2);
+        else if (calls == 5)
+            hashmap_increase_capacity(hm, 4);
+        CuAssertTrue(tc, calls < 10000);
+    }
+    while (cursor);
+
+    CuAssertTrue(tc, 96 == hashmap_size(hm));
+    CuAssertTrue(tc, 0 == hashmap_count(hm2));
+
+    hashmap_freeall(hm);
+    hashmap_freeall(hm2);
+}
+
+void TestHashmaplinked_IterateRange(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm;
+    hashmap_iterator_t iter;
+
+    hm = hashmap_new(__uint_hash, __uint_compare, 11);
+    hashmap_put(hm, (void*)1, (void*)92);
+    hashmap_put(hm, (void*)2, (void*)93);
+    hashmap_put(hm, (void*)3, (void*)94);
+
+    hashmap_iterator_range(hm, &iter, 2, 4);
+    CuAssertTrue(tc, 2 == (unsigned long)hashmap_iterator_next(hm, &iter));
+    CuAssertTrue(tc, 3 == (unsigned long)hashmap_iterator_next(hm, &iter));
+    CuAssertTrue(tc, 0 == hashmap_iterator_has_next(hm, &iter));
+    CuAssertTrue(tc, NULL == hashmap_iterator_next(hm, &iter));
+
+    hashmap_freeall(hm);
+}
+
+void TestHashmaplinked_PartitionCoversEverythingOnce(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm, *hm2;
+    hashmap_iterator_t iters[4];
+    int counts[4], ii, total = 0;
+    unsigned long jj;
+    void *key;
+
+    hm = hashmap_new(__uint_hash, __uint_compare, 11);
+    hm2 = hashmap_new(__uint_hash, __uint_compare, 11);
+
+    /* skewed: lots of collisions in the low buckets */
+    for (jj = 1; jj <= 200; jj++)
+    {
+        hashmap_put(hm, (void*)(jj < 100 ? jj * 512 : jj), (void*)1);
+        hashmap_put(hm2, (void*)(jj < 100 ? jj * 512 : jj), (void*)1);
+    }
+
+    hashmap_iterator_partition(hm, iters, counts, 4);
+
+    for (ii = 0; ii < 4; ii++)
+    {
+        int n = 0;
+
+        while ((key = hashmap_iterator_next(hm, &iters[ii])))
+        {
+            CuAssertTrue(tc, NULL != hashmap_remove(hm2, key));
+            n++;
+        }
+
+        CuAssertTrue(tc, n == counts[ii]);
+        CuAssertTrue(tc, n <= 200 / 4 + 10);
+        total += n;
+    }
+
+    CuAssertTrue(tc, 200 == total);
+    CuAssertTrue(tc, 0 == hashmap_count(hm2));
+
+    hashmap_freeall(hm);
+    hashmap_freeall(hm2);
+}
+
+void TestHashmaplinked_PartitionMoreWaysThanItems(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm;
+    hashmap_iterator_t iters[8];
+    int counts[8], ii, total = 0;
+
+    hm = hashmap_new(__uint_hash, __uint_compare, 11);
+    hashmap_put(hm, (void*)1, (void*)92);
+    hashmap_put(hm, (void*)2, (void*)93);
+
+    hashmap_iterator_partition(hm, iters, counts, 8);
+    for (ii = 0; ii < 8; ii++)
+    {
+        total += counts[ii];
+        while (hashmap_iterator_next(hm, &iters[ii]))
+            counts[ii]--;
+        CuAssertTrue(tc, 0 == counts[ii]);
+    }
+    CuAssertTrue(tc, 2 == total);
+
+    hashmap_freeall(hm);
+}
+
+void TestHashmaplinked_IterateInBatches(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm, *hm2;
+    hashmap_iterator_t iter;
+    hashmap_entry_t batch[3];
+    unsigned long ii;
+    int n, jj, total = 0;
+
+    hm = hashmap_new(__uint_hash, __uint_compare, 64);
+    hm2 = hashmap_new(__uint_hash, __uint_compare, 64);
+
+    for (ii = 1; ii <= 20; ii++)
+    {
+        hashmap_put(hm, (void*)ii, (void*)(ii + 1));
+        hashmap_put(hm2, (void*)ii, (void*)(ii + 1));
+    }
+    /* 1, 65 and 129 share a chain */
+    hashmap_put(hm, (void*)65, (void*)66);
+    hashmap_put(hm2, (void*)65, (void*)66);
+    hashmap_put(hm, (void*)129, (void*)130);
+    hashmap_put(hm2, (void*)129, (void*)130);
+
+    hashmap_iterator(hm, &iter);
+    while ((n = hashmap_iterator_next_batch(hm, &iter, batch, 3)))
+    {
+        CuAssertTrue(tc, n <= 3);
+        for (jj = 0; jj < n; jj++)
+        {
+            CuAssertTrue(tc, (unsigned long)batch[jj].key + 1 ==
+                         (unsigned long)batch[jj].val);
+            CuAssertTrue(tc, batch[jj].val ==
+                         hashmap_remove(hm2, batch[jj].key));
+        }
+        total += n;
+    }
+
+    CuAssertTrue(tc, 22 == total);
+    CuAssertTrue(tc, 0 == hashmap_count(hm2));
+
+    hashmap_freeall(hm);
+    hashmap_freeall(hm2);
+}
+
+void TestHashmaplinked_BatchAndSingleIterationMix(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm, *hm2;
+    hashmap_iterator_t iter;
+    hashmap_entry_t batch[2];
+    void *key;
+    int n, jj;
+
+    hm = hashmap_new(__uint_hash, __uint_compare, 4);
+    hm2 = hashmap_new(__uint_hash, __uint_compare, 4);
+
+    hashmap_put(hm, (void*)1, (void*)92);
+    hashmap_put(hm2, (void*)1, (void*)92);
+    /* stays a collision after growing */
+    hashmap_put(hm, (void*)17, (void*)91);
+    hashmap_put(hm2, (void*)17, (void*)91);
+    hashmap_put(hm, (void*)2, (void*)90);
+    hashmap_put(hm2, (void*)2, (void*)90);
+
+    hashmap_iterator(hm, &iter);
+    do
+    {
+        n = hashmap_iterator_next_batch(hm, &iter, batch, 1);
+        for (jj = 0; jj < n; jj++)
+            CuAssertTrue(tc, NULL != hashmap_remove(hm2, batch[jj].key));
+
+        if ((key = hashmap_iterator_next(hm, &iter)))
+            CuAssertTrue(tc, NULL != hashmap_remove(hm2, key));
+    }
+    while (n || key);
+
+    CuAssertTrue(tc, 0 == hashmap_count(hm2));
+
+    hashmap_freeall(hm);
+    hashmap_freeall(hm2);
+}
+
+void TestHashmaplinked_IteratorRemoveUnlinksAsItGoes(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm;
+    hashmap_iterator_t iter;
+    unsigned long key;
+    int seen = 0;
+
+    hm = hashmap_new(__uint_hash, __uint_compare, 8);
+
+    /* 1, 9 and 17 share a chain */
+    hashmap_put(hm, (void*)1, (void*)91);
+    hashmap_put(hm, (void*)9, (void*)99);
+    hashmap_put(hm, (void*)17, (void*)107);
+    hashmap_put(hm, (void*)2, (void*)92);
+
+    hashmap_iterator(hm, &iter);
+    while ((key = (unsigned long)hashmap_iterator_next(hm, &iter)))
+    {
+        seen++;
+        if (key != 9)
+            CuAssertTrue(tc, key + 90 ==
+                         (unsigned long)hashmap_iterator_remove(hm, &iter));
+    }
+
+    /* nothing to remove twice */
+    CuAssertTrue(tc, NULL == hashmap_iterator_remove(hm, &iter));
+
+    CuAssertTrue(tc, 4 == seen);
+    CuAssertTrue(tc, 1 == hashmap_count(hm));
+    CuAssertTrue(tc, 99 == (unsigned long)hashmap_get(hm, (void*)9));
+
+    hashmap_freeall(hm);
+}
+
+void TestHashmaplinked_IteratorRemoveEverything(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm;
+    hashmap_iterator_t iter;
+    unsigned long ii;
+    int seen = 0;
+
+    hm = hashmap_new(__uint_hash, __uint_compare, 8);
+    for (ii = 1; ii <= 3; ii++)
+    {
+        hashmap_put(hm, (void*)ii, (void*)ii);
+        hashmap_put(hm, (void*)(ii + 8), (void*)ii);
+        hashmap_put(hm, (void*)(ii + 16), (void*)ii);
+    }
+    CuAssertTrue(tc, 9 == hashmap_count(hm));
+
+    hashmap_iterator(hm, &iter);
+    while (hashmap_iterator_next(hm, &iter))
+    {
+        CuAssertTrue(tc, NULL != hashmap_iterator_remove(hm, &iter));
+        seen++;
+    }
+
+    CuAssertTrue(tc, 9 == seen);
+    CuAssertTrue(tc, 0 == hashmap_count(hm));
+
+    hashmap_freeall(hm);
+}
+
+static int __is_even(
+    void *udata,
+    void *key,
+    void *val __attribute__((__unused__))
+    )
+{
+    (*(int*)udata)++;
+    return 0 == (unsigned long)key % 2;
+}
+
+void TestHashmaplinked_RetainKeepsMatchingItems(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm;
+    unsigned long ii;
+    int calls = 0;
+
+    hm = hashmap_new(__uint_hash, __uint_compare, 64);
+    /* long chains: every key lands in one of four buckets */
+    for (ii = 1; ii <= 24; ii++)
+        hashmap_put(hm, (void*)(ii * 64 + ii % 4), (void*)ii);
+    CuAssertTrue(tc, 64 == hashmap_size(hm));
+
+    CuAssertTrue(tc, 12 == hashmap_retain(hm, __is_even, &calls));
+    CuAssertTrue(tc, 24 == calls);
+    CuAssertTrue(tc, 12 == hashmap_count(hm));
+
+    for (ii = 1; ii <= 24; ii++)
+    {
+        void *val = hashmap_get(hm, (void*)(ii * 64 + ii % 4));
+
+        if ((ii * 64 + ii % 4) % 2)
+            CuAssertTrue(tc, NULL == val);
+        else
+            CuAssertTrue(tc, ii == (unsigned long)val);
+    }
+
+    hashmap_freeall(hm);
+}
+
+void TestHashmaplinked_DrainMovesEverythingOut(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm;
+    hashmap_entry_t out[6];
+    unsigned long sum = 0;
+    int ii;
+
+    hm = hashmap_new(__uint_hash, __uint_compare, 4);
+    hashmap_put(hm, (void*)1, (void*)10);
+    hashmap_put(hm, (void*)5, (void*)50);
+    hashmap_put(hm, (void*)9, (void*)90);
+
+    CuAssertTrue(tc, 3 == hashmap_drain(hm, out));
+    CuAssertTrue(tc, 0 == hashmap_count(hm));
+    CuAssertTrue(tc, NULL == hashmap_get(hm, (void*)5));
+
+    for (ii = 0; ii < 3; ii++)
+    {
+        CuAssertTrue(tc, (unsigned long)out[ii].key * 10 ==
+                     (unsigned long)out[ii].val);
+        sum += (unsigned long)out[ii].key;
+    }
+    CuAssertTrue(tc, 15 == sum);
+
+    /* the map is still usable */
+    hashmap_put(hm, (void*)1, (void*)11);
+    hashmap_put(hm, (void*)5, (void*)51);
+    CuAssertTrue(tc, 51 == (unsigned long)hashmap_get(hm, (void*)5));
+    CuAssertTrue(tc, 2 == hashmap_count(hm));
+
+    hashmap_freeall(hm);
+}
+
+void TestHashmaplinked_SwapExchangesContents(
+    CuTest * tc
+    )
+{
+    hashmap_t *a, *b;
+
+    a = hashmap_new(__uint_hash, __uint_compare, 4);
+    b = hashmap_new(__uint_hash, __uint_compare, 11);
+    hashmap_put(a, (void*)1, (void*)10);
+    hashmap_put(a, (void*)5, (void*)50);
+    hashmap_put(b, (void*)2, (void*)20);
+
+    hashmap_swap(a, b);
+
+    CuAssertTrue(tc, 1 == hashmap_count(a));
+    CuAssertTrue(tc, 11 == hashmap_size(a));
+    CuAssertTrue(tc, 20 == (unsigned long)hashmap_get(a, (void*)2));
+    CuAssertTrue(tc, 2 == hashmap_count(b));
+    CuAssertTrue(tc, 50 == (unsigned long)hashmap_get(b, (void*)5));
+    CuAssertTrue(tc, NULL == hashmap_get(b, (void*)2));
+
+    hashmap_freeall(a);
+    hashmap_freeall(b);
+}
+
+void TestHashmaplinked_CloneIsIndependent(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm, *clone;
+    unsigned long ii;
+
+    hm = hashmap_new(__uint_hash, __uint_compare, 8);
+    for (ii = 1; ii <= 3; ii++)
+    {
+        hashmap_put(hm, (void*)ii, (void*)(ii + 1));
+        /* collide */
+        hashmap_put(hm, (void*)(ii + 16), (void*)(ii + 17));
+    }
+
+    clone = hashmap_clone(hm);
+    CuAssertTrue(tc, 6 == hashmap_count(clone));
+    CuAssertTrue(tc, hashmap_size(hm) == hashmap_size(clone));
+    for (ii = 1; ii <= 3; ii++)
+    {
+        CuAssertTrue(tc, ii + 1 == (unsigned long)hashmap_get(clone, (void*)ii));
+        CuAssertTrue(tc, ii + 17 ==
+                     (unsigned long)hashmap_get(clone, (void*)(ii + 16)));
+    }
+
+    /* changes to one don't show up in the other */
+    hashmap_remove(hm, (void*)17);
+    hashmap_remove(clone, (void*)1);
+    hashmap_put(clone, (void*)33, (void*)34);
+    CuAssertTrue(tc, 18 == (unsigned long)hashmap_get(clone, (void*)17));
+    CuAssertTrue(tc, 2 == (unsigned long)hashmap_get(hm, (void*)1));
+    CuAssertTrue(tc, NULL == hashmap_get(hm, (void*)33));
+    CuAssertTrue(tc, 5 == hashmap_count(hm));
+    CuAssertTrue(tc, 6 == hashmap_count(clone));
+
+    hashmap_freeall(hm);
+    hashmap_freeall(clone);
+}
+
+void TestHashmaplinked_DirtyBucketsFollowChanges(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm;
+    unsigned long ii;
+
+    hm = hashmap_new(__uint_hash, __uint_compare, 200);
+    for (ii = 1; ii <= 50; ii++)
+        hashmap_put(hm, (void*)ii, (void*)ii);
+
+    /* not tracking */
+    CuAssertTrue(tc, -1 == hashmap_next_dirty(hm, 0));
+
+    hashmap_track_dirty(hm, 1);
+    CuAssertTrue(tc, -1 == hashmap_next_dirty(hm, 0));
+
+    hashmap_put(hm, (void*)70, (void*)70);
+    hashmap_remove(hm, (void*)3);
+    hashmap_put(hm, (void*)10, (void*)11);
+    /* no change */
+    hashmap_put_if_absent(hm, (void*)20, (void*)21);
+    hashmap_remove(hm, (void*)150);
+
+    CuAssertTrue(tc, 3 == hashmap_next_dirty(hm, 0));
+    CuAssertTrue(tc, 10 == hashmap_next_dirty(hm, 4));
+    CuAssertTrue(tc, 70 == hashmap_next_dirty(hm, 11));
+    CuAssertTrue(tc, -1 == hashmap_next_dirty(hm, 71));
+
+    hashmap_clear_dirty(hm);
+    CuAssertTrue(tc, -1 == hashmap_next_dirty(hm, 0));
+
+    /* growing moves every bucket */
+    for (ii = 100; ii < 160; ii++)
+        hashmap_put(hm, (void*)ii, (void*)ii);
+    CuAssertTrue(tc, 200 < hashmap_size(hm));
+    for (ii = 0; ii < (unsigned long)hashmap_size(hm); ii++)
+        CuAssertTrue(tc, (int)ii == hashmap_next_dirty(hm, ii));
+
+    hashmap_track_dirty(hm, 0);
+    CuAssertTrue(tc, -1 == hashmap_next_dirty(hm, 0));
+    hashmap_freeall(hm);
+}
+
+static void __record_op(
+    void *udata,
+    int op,
+    unsigned long hash,
+    void *key,
+    void *val __attribute__((__unused__))
+    )
+{
+    unsigned long *ops = udata;
+
+    assert(!key || hash == (unsigned long)key);
+    ops[op]++;
+}
+
+void TestHashmaplinked_MutationHookSeesChanges(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm;
+    unsigned long ii, ops[4] = { 0 };
+
+    hm = hashmap_new(__uint_hash, __uint_compare, 11);
+    hashmap_set_mutation_hook(hm, __record_op, ops);
+
+    /* growing is not a change */
+    for (ii = 1; ii <= 40; ii++)
+        hashmap_put(hm, (void*)ii, (void*)ii);
+    CuAssertTrue(tc, 40 == ops[HASHMAP_OP_PUT]);
+
+    hashmap_put(hm, (void*)1, (void*)2);
+    hashmap_put_if_absent(hm, (void*)2, (void*)3);
+    hashmap_replace_if(hm, (void*)3, (void*)3, (void*)4);
+    hashmap_replace_if(hm, (void*)3, (void*)3, (void*)5);
+    CuAssertTrue(tc, 42 == ops[HASHMAP_OP_PUT]);
+
+    hashmap_remove(hm, (void*)4);
+    hashmap_remove(hm, (void*)4);
+    hashmap_remove_if(hm, (void*)5, (void*)5);
+    CuAssertTrue(tc, 2 == ops[HASHMAP_OP_REMOVE]);
+
+    hashmap_clear(hm);
+    CuAssertTrue(tc, 1 == ops[HASHMAP_OP_CLEAR]);
+
+    hashmap_set_mutation_hook(hm, NULL, NULL);
+    hashmap_put(hm, (void*)1, (void*)2);
+    CuAssertTrue(tc, 42 == ops[HASHMAP_OP_PUT]);
+    hashmap_freeall(hm);
+}
+
+void TestHashmaplinked_FreezeKeepsLookups(
+    CuTest * tc
+    )
+{
+    hashmap_t *hm;
+    hashmap_frozen_t *f;
+    unsigned long ii;
+    int b;
+
+    hm = hashmap_new(__uint_hash, __uint_compare, 16);
+    for (ii = 1; ii <= 300; ii++)
+        hashmap_put(hm, (void*)ii, (void*)(ii + 1));
+    /* collide */
+    for (ii = 1; ii <= 5; ii++)
+        hashmap_put(hm, (void*)(ii + 1024), (void*)ii);
+    hashmap_remove(hm, (void*)3);
+
+    f = hashmap_freeze(hm);
+    CuAssertTrue(tc, 304 == hashmap_frozen_count(f));
+    for (ii = 1; ii <= 300; ii++)
+        if (3 != ii)
+            CuAssertTrue(tc, ii + 1 ==
+                         (unsigned long)hashmap_frozen_get(f, (void*)ii));
+    for (ii = 1; ii <= 5; ii++)
+        CuAssertTrue(tc, ii ==
+                     (unsigned long)hashmap_frozen_get(f, (void*)(ii + 1024)));
+    CuAssertTrue(tc, !hashmap_frozen_contains_key(f, (void*)3));
+    CuAssertTrue(tc, hashmap_frozen_contains_key(f, (void*)4));
+    CuAssertTrue(tc, NULL == hashmap_frozen_get(f, (void*)5000));
+
+    /* every entry sits in its own bucket's range */
+    for (b = 0; b < f->nbuckets; b++)
+    {
+        unsigned int jj;
+
+        for (jj = f->offsets[b]; jj < f->offsets[b + 1]; jj++)
+            CuAssertTrue(tc, (unsigned long)b ==
+                         (unsigned long)f->entries[jj].key % f->nbuckets);
+    }
+    CuAssertTrue(tc, 304 == f->offsets[f->nbuckets]);
+
+    hashmap_frozen_free(f);
+}
+
+void TestHashmaplinked_FreezeEmptyMap(
+    CuTest * tc
+    )
+{
+    hashmap_frozen_t *f;
+
+    f = hashmap_freeze(hashmap_new(__uint_hash, __uint_compare, 11));
+    CuAssertTrue(tc, 0 == hashmap_frozen_count(f));
+    CuAssertTrue(tc, NULL == hashmap_frozen_get(f, (void*)1));
+    hashmap_frozen_free(f);
+}
+
+void TestHashmaplinked_SwapKeepsDirtyTracking(
+    CuTest * tc
+    )
+{
+    hashmap_t *a, *b;
+    unsigned long ii;
+
+    a = hashmap_new(__uint_hash, __uint_compare, 11);
+    b = hashmap_new(__uint_hash, __uint_compare, 300);
+    for (ii = 1; ii <= 100; ii++)
+        hashmap_put(b, (void*)ii, (void*)ii);
+    hashmap_track_dirty(a, 1);
+
+    /* a's bitmap now covers b's bigger table, all of it changed */
+    hashmap_swap(a, b);
+    CuAssertTrue(tc, 300 == hashmap_size(a));
+    for (ii = 0; ii < 300; ii++)
+        CuAssertTrue(tc, (int)ii == hashmap_next_dirty(a, ii));
+    CuAssertTrue(tc, -1 == hashmap_next_dirty(b, 0));
+
+    hashmap_clear_dirty(a);
+    hashmap_put(a, (void*)7, (void*)8);
+    CuAssertTrue(tc, 7 == hashmap_next_dirty(a, 0));
+
+    hashmap_freeall(a);
+    hashmap_freeall(b);
+}